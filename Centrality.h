@@ -0,0 +1,217 @@
+
+
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+
+#include "Graph.h"
+#include "CompactGraph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <limits>
+
+/** \brief Accumulate betweenness centrality from a set of sources.
+*	\param compact is a snapshot of the graph.
+*	\param sources are the dense ids of the vertices from which
+*		   shortest paths are counted.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the centrality of each vertex, indexed by dense id.
+*
+*	This is Brandes' algorithm for unweighted graphs: a breadth-first
+*	search from each source counts shortest paths, and dependencies are
+*	then accumulated in reverse visiting order. Sources are distributed
+*	among the threads, each of which owns its search state and its own
+*	centrality accumulator; the accumulators are summed at the end, so
+*	threads never write to shared memory.\n
+*	In a directed graph the paths follow the edges' directions. Each
+*	undirected path is counted once from either end, so the result is
+*	halved for undirected graphs. It is not otherwise normalized.
+*/
+template <typename K, typename V, typename E, typename P>
+std::vector<double> brandes_betweenness_centrality(const compact_graph<K, V, E, P>& compact, const std::vector<size_t>& sources, size_t thread_count = 0)
+{
+	const size_t unvisited = std::numeric_limits<size_t>::max();
+
+	size_t vertex_count = compact.get_size();
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+	thread_count = std::max(std::min(thread_count, sources.size()), size_t(1));
+
+	struct search_state
+	{
+		search_state(size_t vertex_count)
+		: centrality(vertex_count, 0.0), path_counts(vertex_count, 0.0), dependencies(vertex_count, 0.0),
+		  distances(vertex_count, std::numeric_limits<size_t>::max())
+		{
+			order.reserve(vertex_count);
+		}
+
+		std::vector<double> centrality;
+		std::vector<double> path_counts;
+		std::vector<double> dependencies;
+		std::vector<size_t> distances;
+		// The vertices in the order they were visited; doubles as the queue.
+		std::vector<size_t> order;
+	};
+
+	std::vector<search_state> states(thread_count, search_state(vertex_count));
+
+	parallel_for(0, sources.size(), [&](size_t first, size_t last, size_t thread_index)
+	{
+		search_state& state = states[thread_index];
+
+		for (size_t source_index = first; source_index < last; ++source_index)
+		{
+			size_t source = sources[source_index];
+
+			state.order.clear();
+			state.order.push_back(source);
+			state.path_counts[source] = 1.0;
+			state.distances[source] = 0;
+
+			for (size_t head = 0; head < state.order.size(); ++head)
+			{
+				size_t current = state.order[head];
+
+				for (size_t position = compact.offsets[current]; position < compact.offsets[current + 1]; ++position)
+				{
+					size_t next = compact.targets[position];
+
+					if (state.distances[next] == unvisited)
+					{
+						state.distances[next] = state.distances[current] + 1;
+						state.order.push_back(next);
+					}
+
+					if (state.distances[next] == state.distances[current] + 1)
+						state.path_counts[next] += state.path_counts[current];
+				}
+			}
+
+			// Accumulate dependencies from the farthest vertices back to the
+			// source, pulling them from the successors on shortest paths so
+			// that only the out-neighbours are needed.
+			for (size_t index = state.order.size(); index-- > 0; )
+			{
+				size_t current = state.order[index];
+
+				for (size_t position = compact.offsets[current]; position < compact.offsets[current + 1]; ++position)
+				{
+					size_t next = compact.targets[position];
+
+					if (state.distances[next] == state.distances[current] + 1)
+						state.dependencies[current] += state.path_counts[current] / state.path_counts[next] * (1.0 + state.dependencies[next]);
+				}
+
+				if (current != source)
+					state.centrality[current] += state.dependencies[current];
+			}
+
+			// Only the visited vertices need to be reset.
+			for (size_t current : state.order)
+			{
+				state.path_counts[current] = 0.0;
+				state.dependencies[current] = 0.0;
+				state.distances[current] = unvisited;
+			}
+		}
+	}, thread_count, 1);
+
+	std::vector<double> centrality(vertex_count, 0.0);
+
+	parallel_for(0, vertex_count, [&](size_t first, size_t last, size_t)
+	{
+		for (size_t id = first; id < last; ++id)
+		{
+			for (auto& state : states)
+				centrality[id] += state.centrality[id];
+
+			if (!P::directed)
+				centrality[id] /= 2.0;
+		}
+	}, thread_count);
+
+	return centrality;
+}
+
+/** \brief Compute the betweenness centrality of every vertex.
+*	\param graph is the graph to analyse.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the centrality of each vertex, keyed as in the graph.
+*
+*	Every vertex is used as a source, so this runs in O(V * E) time
+*	divided among the threads. Edges are unweighted.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+std::unordered_map<K, double, H> betweenness_centrality(const dynamic_sparse_graph<K, H, V, E, P>& graph, size_t thread_count = 0)
+{
+	compact_graph<K, V, E, P> compact = make_compact_graph(graph, thread_count);
+
+	std::vector<size_t> sources(compact.get_size());
+	for (size_t id = 0; id < sources.size(); ++id)
+		sources[id] = id;
+
+	std::vector<double> centrality = brandes_betweenness_centrality(compact, sources, thread_count);
+
+	std::unordered_map<K, double, H> result;
+	result.reserve(compact.get_size());
+	for (size_t id = 0; id < compact.get_size(); ++id)
+		result.insert(std::make_pair(compact.keys[id], centrality[id]));
+
+	return result;
+}
+
+/** \brief Estimate the betweenness centrality of every vertex.
+*	\param graph is the graph to analyse.
+*	\param sample_count is the number of sources to sample.
+*	\param seed seeds the choice of sources, making runs repeatable.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the estimated centrality of each vertex, keyed as in the
+*			graph.
+*
+*	sample_count distinct sources are drawn uniformly at random and the
+*	accumulated centrality is scaled by get_size() / sample_count, which
+*	gives an unbiased estimate of the exact value in
+*	O(sample_count * E) time. If sample_count is at least the number of
+*	vertices, the result is exact.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+std::unordered_map<K, double, H> approximate_betweenness_centrality(const dynamic_sparse_graph<K, H, V, E, P>& graph, size_t sample_count, unsigned long long seed = 0, size_t thread_count = 0)
+{
+	compact_graph<K, V, E, P> compact = make_compact_graph(graph, thread_count);
+
+	size_t vertex_count = compact.get_size();
+	sample_count = std::min(sample_count, vertex_count);
+
+	std::vector<size_t> sources(vertex_count);
+	for (size_t id = 0; id < vertex_count; ++id)
+		sources[id] = id;
+
+	// Partial Fisher-Yates shuffle: the first sample_count ids become the sample.
+	std::mt19937_64 generator(seed);
+	for (size_t index = 0; index < sample_count; ++index)
+	{
+		std::uniform_int_distribution<size_t> distribution(index, vertex_count - 1);
+		std::swap(sources[index], sources[distribution(generator)]);
+	}
+	sources.resize(sample_count);
+
+	std::vector<double> centrality = brandes_betweenness_centrality(compact, sources, thread_count);
+
+	double scale = sample_count > 0 ? double(vertex_count) / double(sample_count) : 0.0;
+
+	std::unordered_map<K, double, H> result;
+	result.reserve(vertex_count);
+	for (size_t id = 0; id < vertex_count; ++id)
+		result.insert(std::make_pair(compact.keys[id], centrality[id] * scale));
+
+	return result;
+}
+
+#endif // CENTRALITY_H
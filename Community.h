@@ -0,0 +1,584 @@
+
+
+#ifndef COMMUNITY_H
+#define COMMUNITY_H
+
+#include "Graph.h"
+#include "CompactGraph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+/** \brief A weighted graph in compressed sparse row form.
+*
+*	This is the working representation of the community detection
+*	routines. Vertex i's neighbours are targets[offsets[i]] to
+*	targets[offsets[i + 1] - 1], with the matching entries of weights.
+*	A community collapsed into a single vertex keeps its internal
+*	weight as an entry pointing back at itself.
+*/
+struct weighted_compact_graph
+{
+	/** \brief Retrieve the number of vertices in the graph.
+	*	\return the number of vertices in the graph.
+	*/
+	size_t get_size() const
+	{
+		return offsets.size() - 1;
+	}
+
+	/** \brief The position in targets of each vertex's first neighbour.
+	*/
+	std::vector<size_t> offsets;
+	/** \brief The neighbours of every vertex.
+	*/
+	std::vector<size_t> targets;
+	/** \brief The weight of each entry of targets.
+	*/
+	std::vector<double> weights;
+	/** \brief The total weight of each vertex's entries.
+	*/
+	std::vector<double> strengths;
+	/** \brief The sum of strengths, i.e. twice the total edge weight.
+	*/
+	double total_weight;
+};
+
+namespace community_detail
+{
+	/** \brief Mixes a seed and a value into a well-distributed hash.
+	*
+	*	This is the splitmix64 finalizer; it gives the community routines
+	*	their seeded, thread-count independent choices.
+	*/
+	inline std::uint64_t mix(std::uint64_t seed, std::uint64_t value)
+	{
+		std::uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (value + 1);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	/** \brief A dense map from ids to weights which is cheap to clear.
+	*
+	*	Each thread owns one; only the ids touched since the last clear are
+	*	reset, so scanning a vertex's neighbourhood costs its degree rather
+	*	than the number of vertices. Whether an id is touched is kept apart
+	*	from its weight, which may be zero.
+	*/
+	struct weight_accumulator
+	{
+		weight_accumulator(size_t size)
+		: weights(size, 0.0), seen(size, false)
+		{
+
+		}
+
+		void add(size_t id, double weight)
+		{
+			if (!seen[id])
+			{
+				seen[id] = true;
+				touched.push_back(id);
+			}
+			weights[id] += weight;
+		}
+
+		void clear()
+		{
+			for (size_t id : touched)
+			{
+				weights[id] = 0.0;
+				seen[id] = false;
+			}
+			touched.clear();
+		}
+
+		std::vector<double> weights;
+		std::vector<bool> seen;
+		std::vector<size_t> touched;
+	};
+
+	/** \brief Renumbers labels densely in order of first appearance.
+	*	\return the number of distinct labels.
+	*/
+	inline size_t renumber(std::vector<size_t>& labels)
+	{
+		const size_t none = std::numeric_limits<size_t>::max();
+
+		std::vector<size_t> numbers(labels.size(), none);
+		size_t count = 0;
+
+		for (auto& label : labels)
+		{
+			if (numbers[label] == none)
+				numbers[label] = count++;
+			label = numbers[label];
+		}
+
+		return count;
+	}
+
+	/** \brief Translates dense community labels back to graph keys.
+	*/
+	template <typename K, typename H, typename V, typename E, typename P>
+	std::unordered_map<K, size_t, H> by_key(const compact_graph<K, V, E, P>& compact, const std::vector<size_t>& labels)
+	{
+		std::unordered_map<K, size_t, H> result;
+		result.reserve(compact.get_size());
+
+		for (size_t id = 0; id < compact.get_size(); ++id)
+			result.insert(std::make_pair(compact.keys[id], labels[id]));
+
+		return result;
+	}
+}
+
+/** \brief Make a weighted compact graph from a snapshot of a graph.
+*	\param compact is a snapshot of the graph.
+*	\param weight is called as weight(edge_data) and returns a
+*		   non-negative value convertible to double.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the weighted graph, with the same dense ids as compact.
+*
+*	Modularity is defined here for undirected graphs only, so compact
+*	must be a snapshot of one.
+*/
+template <typename K, typename V, typename E, typename P, typename W>
+weighted_compact_graph make_weighted_compact_graph(const compact_graph<K, V, E, P>& compact, W weight, size_t thread_count = 0)
+{
+	static_assert(!P::directed, "make_weighted_compact_graph: the graph must be undirected");
+
+	weighted_compact_graph weighted;
+
+	weighted.offsets = compact.offsets;
+	weighted.targets = compact.targets;
+	weighted.weights.resize(compact.targets.size());
+	weighted.strengths.resize(compact.get_size());
+
+	parallel_for(0, compact.get_size(), [&](size_t first, size_t last, size_t)
+	{
+		for (size_t id = first; id < last; ++id)
+		{
+			double strength = 0.0;
+
+			for (size_t position = compact.offsets[id]; position < compact.offsets[id + 1]; ++position)
+			{
+				weighted.weights[position] = double(weight(compact.edges[position]->data));
+				strength += weighted.weights[position];
+			}
+
+			weighted.strengths[id] = strength;
+		}
+	}, thread_count);
+
+	weighted.total_weight = 0.0;
+	for (double strength : weighted.strengths)
+		weighted.total_weight += strength;
+
+	return weighted;
+}
+
+/** \brief Compute the modularity of a partition of a weighted graph.
+*	\param graph is the weighted graph.
+*	\param communities is the community of each vertex.
+*	\return the modularity, in [-1/2, 1].
+*/
+inline double modularity(const weighted_compact_graph& graph, const std::vector<size_t>& communities)
+{
+	if (graph.total_weight <= 0.0)
+		return 0.0;
+
+	std::vector<double> internal(graph.get_size(), 0.0);
+	std::vector<double> totals(graph.get_size(), 0.0);
+
+	for (size_t id = 0; id < graph.get_size(); ++id)
+	{
+		totals[communities[id]] += graph.strengths[id];
+
+		for (size_t position = graph.offsets[id]; position < graph.offsets[id + 1]; ++position)
+		{
+			if (communities[graph.targets[position]] == communities[id])
+				internal[communities[id]] += graph.weights[position];
+		}
+	}
+
+	double result = 0.0;
+	for (size_t community = 0; community < graph.get_size(); ++community)
+		result += internal[community] / graph.total_weight - (totals[community] / graph.total_weight) * (totals[community] / graph.total_weight);
+
+	return result;
+}
+
+/** \brief Detect communities by label propagation.
+*	\param graph is the graph to partition.
+*	\param seed seeds the tie-breaking and update order.
+*	\param max_iterations bounds the number of rounds.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the community of each vertex, numbered from 0 and keyed
+*			as in the graph.
+*
+*	Every vertex starts in its own community and repeatedly adopts the
+*	label carried by most of its neighbours. Each round updates the
+*	vertices in two halves chosen by the seed: vertices of one half are
+*	relabelled in parallel from the labels of the other, which avoids
+*	the oscillation of fully synchronous updates while keeping every
+*	decision independent of thread scheduling. Ties are broken by a
+*	seeded hash of the labels. The result depends only on the graph's
+*	iteration order and the seed. Edges are unweighted, and the graph
+*	must be undirected.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+std::unordered_map<K, size_t, H> label_propagation_communities(const dynamic_sparse_graph<K, H, V, E, P>& graph, std::uint64_t seed = 0, size_t max_iterations = 100, size_t thread_count = 0)
+{
+	static_assert(!P::directed, "label_propagation_communities: the graph must be undirected");
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+
+	compact_graph<K, V, E, P> compact = make_compact_graph(graph, thread_count);
+
+	size_t vertex_count = compact.get_size();
+
+	std::vector<size_t> labels(vertex_count);
+	for (size_t id = 0; id < vertex_count; ++id)
+		labels[id] = id;
+
+	std::vector<community_detail::weight_accumulator> accumulators(thread_count, community_detail::weight_accumulator(vertex_count));
+
+	// Labels are read from labels and written to next_labels, so vertices
+	// of the same half never observe each other's updates.
+	std::vector<size_t> next_labels(labels);
+
+	for (size_t iteration = 0; iteration < max_iterations; ++iteration)
+	{
+		std::atomic<size_t> changes(0);
+
+		for (std::uint64_t half = 0; half < 2; ++half)
+		{
+			parallel_for(0, vertex_count, [&](size_t first, size_t last, size_t thread_index)
+			{
+				community_detail::weight_accumulator& counts = accumulators[thread_index];
+				size_t local_changes = 0;
+
+				for (size_t id = first; id < last; ++id)
+				{
+					if ((community_detail::mix(seed + iteration, id) & 1) != half)
+						continue;
+
+					for (size_t position = compact.offsets[id]; position < compact.offsets[id + 1]; ++position)
+						counts.add(labels[compact.targets[position]], 1.0);
+
+					size_t best_label = labels[id];
+					double best_count = counts.weights[best_label];
+					std::uint64_t best_rank = community_detail::mix(seed, best_label);
+
+					for (size_t label : counts.touched)
+					{
+						std::uint64_t rank = community_detail::mix(seed, label);
+
+						if (counts.weights[label] > best_count
+							|| (counts.weights[label] == best_count && rank < best_rank))
+						{
+							best_label = label;
+							best_count = counts.weights[label];
+							best_rank = rank;
+						}
+					}
+
+					counts.clear();
+
+					if (best_label != labels[id])
+					{
+						next_labels[id] = best_label;
+						++local_changes;
+					}
+				}
+
+				changes += local_changes;
+			}, thread_count);
+
+			labels = next_labels;
+		}
+
+		if (changes == 0)
+			break;
+	}
+
+	community_detail::renumber(labels);
+
+	return community_detail::by_key<K, H>(compact, labels);
+}
+
+/** \brief Optimize modularity over one level of the Louvain method.
+*	\param graph is the weighted graph of the current level.
+*	\param communities is the community of each vertex; it is updated.
+*	\param seed seeds the update order.
+*	\param max_iterations bounds the number of rounds.
+*	\param thread_count is the number of threads to use.
+*	\return true if any vertex changed community.
+*
+*	As in label_propagation_communities, every round moves the vertices
+*	of two seeded halves in turn: the best move of each vertex in a half
+*	is computed in parallel against frozen community totals, and the
+*	moves are then applied. A vertex which is alone in its community
+*	only joins another singleton community with a lower id, which stops
+*	pairs of vertices from endlessly swapping.
+*/
+inline bool louvain_local_moving(const weighted_compact_graph& graph, std::vector<size_t>& communities, std::uint64_t seed, size_t max_iterations, size_t thread_count)
+{
+	const double minimum_gain = 1e-12;
+
+	size_t vertex_count = graph.get_size();
+
+	std::vector<double> totals(vertex_count, 0.0);
+	std::vector<size_t> sizes(vertex_count, 0);
+	for (size_t id = 0; id < vertex_count; ++id)
+	{
+		totals[communities[id]] += graph.strengths[id];
+		++sizes[communities[id]];
+	}
+
+	std::vector<size_t> moves(vertex_count);
+	std::vector<community_detail::weight_accumulator> accumulators(thread_count, community_detail::weight_accumulator(vertex_count));
+
+	bool moved = false;
+
+	for (size_t iteration = 0; iteration < max_iterations; ++iteration)
+	{
+		size_t changes = 0;
+
+		for (std::uint64_t half = 0; half < 2; ++half)
+		{
+			parallel_for(0, vertex_count, [&](size_t first, size_t last, size_t thread_index)
+			{
+				community_detail::weight_accumulator& links = accumulators[thread_index];
+
+				for (size_t id = first; id < last; ++id)
+				{
+					size_t current = communities[id];
+					moves[id] = current;
+
+					if ((community_detail::mix(seed + iteration, id) & 1) != half)
+						continue;
+
+					for (size_t position = graph.offsets[id]; position < graph.offsets[id + 1]; ++position)
+					{
+						if (graph.targets[position] != id)
+							links.add(communities[graph.targets[position]], graph.weights[position]);
+					}
+
+					// The gain of joining a community, relative to being alone.
+					double strength = graph.strengths[id];
+					double scale = strength / graph.total_weight;
+					double stay_gain = links.weights[current] - (totals[current] - strength) * scale;
+					double best_gain = stay_gain;
+					size_t best = current;
+
+					for (size_t candidate : links.touched)
+					{
+						if (candidate == current)
+							continue;
+						if (sizes[current] == 1 && sizes[candidate] == 1 && candidate > current)
+							continue;
+
+						double gain = links.weights[candidate] - totals[candidate] * scale;
+
+						if (best == current ? gain > stay_gain + minimum_gain : (gain > best_gain || (gain == best_gain && candidate < best)))
+						{
+							best_gain = gain;
+							best = candidate;
+						}
+					}
+
+					links.clear();
+
+					moves[id] = best;
+				}
+			}, thread_count);
+
+			for (size_t id = 0; id < vertex_count; ++id)
+			{
+				if (moves[id] != communities[id])
+				{
+					totals[communities[id]] -= graph.strengths[id];
+					--sizes[communities[id]];
+					totals[moves[id]] += graph.strengths[id];
+					++sizes[moves[id]];
+
+					communities[id] = moves[id];
+					++changes;
+				}
+			}
+		}
+
+		if (changes == 0)
+			break;
+
+		moved = true;
+	}
+
+	return moved;
+}
+
+/** \brief Collapse each community of a weighted graph into a vertex.
+*	\param graph is the weighted graph.
+*	\param communities is the community of each vertex, numbered densely.
+*	\param community_count is the number of communities.
+*	\param thread_count is the number of threads to use.
+*	\return the graph of communities.
+*
+*	The members of each community are first gathered contiguously with
+*	a counting sort. Each community's row is then built in parallel by
+*	summing the weights of its members' entries per neighbouring
+*	community in a thread-local dense accumulator, and the rows are
+*	finally packed into a new compressed sparse row graph. The weight
+*	inside a community becomes an entry from the community to itself.
+*/
+inline weighted_compact_graph aggregate_communities(const weighted_compact_graph& graph, const std::vector<size_t>& communities, size_t community_count, size_t thread_count)
+{
+	size_t vertex_count = graph.get_size();
+
+	// Gather the members of each community contiguously.
+	std::vector<size_t> member_offsets(community_count + 1, 0);
+	for (size_t id = 0; id < vertex_count; ++id)
+		++member_offsets[communities[id] + 1];
+	for (size_t community = 0; community < community_count; ++community)
+		member_offsets[community + 1] += member_offsets[community];
+
+	std::vector<size_t> members(vertex_count);
+	std::vector<size_t> cursors(member_offsets.begin(), member_offsets.end() - 1);
+	for (size_t id = 0; id < vertex_count; ++id)
+		members[cursors[communities[id]]++] = id;
+
+	std::vector<std::vector<size_t> > row_targets(community_count);
+	std::vector<std::vector<double> > row_weights(community_count);
+	std::vector<community_detail::weight_accumulator> accumulators(thread_count, community_detail::weight_accumulator(community_count));
+
+	parallel_for(0, community_count, [&](size_t first, size_t last, size_t thread_index)
+	{
+		community_detail::weight_accumulator& links = accumulators[thread_index];
+
+		for (size_t community = first; community < last; ++community)
+		{
+			for (size_t member = member_offsets[community]; member < member_offsets[community + 1]; ++member)
+			{
+				size_t id = members[member];
+
+				for (size_t position = graph.offsets[id]; position < graph.offsets[id + 1]; ++position)
+					links.add(communities[graph.targets[position]], graph.weights[position]);
+			}
+
+			row_targets[community] = links.touched;
+			row_weights[community].reserve(links.touched.size());
+			for (size_t target : links.touched)
+				row_weights[community].push_back(links.weights[target]);
+
+			links.clear();
+		}
+	}, thread_count, 64);
+
+	weighted_compact_graph aggregate;
+
+	aggregate.offsets.resize(community_count + 1);
+	aggregate.offsets[0] = 0;
+	for (size_t community = 0; community < community_count; ++community)
+		aggregate.offsets[community + 1] = aggregate.offsets[community] + row_targets[community].size();
+
+	aggregate.targets.resize(aggregate.offsets[community_count]);
+	aggregate.weights.resize(aggregate.offsets[community_count]);
+	aggregate.strengths.assign(community_count, 0.0);
+
+	parallel_for(0, community_count, [&](size_t first, size_t last, size_t)
+	{
+		for (size_t community = first; community < last; ++community)
+		{
+			std::copy(row_targets[community].begin(), row_targets[community].end(), aggregate.targets.begin() + aggregate.offsets[community]);
+			std::copy(row_weights[community].begin(), row_weights[community].end(), aggregate.weights.begin() + aggregate.offsets[community]);
+
+			for (double weight : row_weights[community])
+				aggregate.strengths[community] += weight;
+		}
+	}, thread_count);
+
+	aggregate.total_weight = graph.total_weight;
+
+	return aggregate;
+}
+
+/** \brief Detect communities with the Louvain method.
+*	\param graph is the graph to partition.
+*	\param weight is called as weight(edge_data) and returns a
+*		   non-negative value convertible to double.
+*	\param seed seeds the update order.
+*	\param max_iterations bounds the number of rounds per level.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the community of each vertex, numbered from 0 and keyed
+*			as in the graph.
+*
+*	Each level moves vertices between communities to increase
+*	modularity (see louvain_local_moving) and then collapses every
+*	community into a single vertex of the next level's graph (see
+*	aggregate_communities). Levels repeat until no vertex moves or
+*	modularity stops improving. The result depends only on the graph's
+*	iteration order and the seed. The graph must be undirected.
+*/
+template <typename K, typename H, typename V, typename E, typename P, typename W>
+std::unordered_map<K, size_t, H> louvain_communities(const dynamic_sparse_graph<K, H, V, E, P>& graph, W weight, std::uint64_t seed = 0, size_t max_iterations = 100, size_t thread_count = 0)
+{
+	static_assert(!P::directed, "louvain_communities: the graph must be undirected");
+
+	const double minimum_improvement = 1e-7;
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+
+	compact_graph<K, V, E, P> compact = make_compact_graph(graph, thread_count);
+	weighted_compact_graph level = make_weighted_compact_graph(compact, weight, thread_count);
+
+	// The community of each vertex of the original graph.
+	std::vector<size_t> labels(compact.get_size());
+	for (size_t id = 0; id < labels.size(); ++id)
+		labels[id] = id;
+
+	double quality = -1.0;
+
+	for (std::uint64_t depth = 0; level.get_size() > 1; ++depth)
+	{
+		std::vector<size_t> communities(level.get_size());
+		for (size_t id = 0; id < communities.size(); ++id)
+			communities[id] = id;
+
+		if (!louvain_local_moving(level, communities, community_detail::mix(seed, depth), max_iterations, thread_count))
+			break;
+
+		size_t community_count = community_detail::renumber(communities);
+
+		double level_quality = modularity(level, communities);
+		if (level_quality < quality + minimum_improvement)
+			break;
+		quality = level_quality;
+
+		for (auto& label : labels)
+			label = communities[label];
+
+		if (community_count == level.get_size())
+			break;
+
+		level = aggregate_communities(level, communities, community_count, thread_count);
+	}
+
+	community_detail::renumber(labels);
+
+	return community_detail::by_key<K, H>(compact, labels);
+}
+
+#endif // COMMUNITY_H
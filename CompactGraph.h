@@ -0,0 +1,131 @@
+
+
+#ifndef COMPACT_GRAPH_H
+#define COMPACT_GRAPH_H
+
+#include "Graph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <unordered_map>
+
+/** \brief A read-only, compressed sparse row snapshot of a graph.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*	\tparam P is the policy of the graph the snapshot was made from.
+*
+*	The vertices of the snapshot are numbered densely from 0 to
+*	get_size() - 1, and the neighbours of the vertex with id i are
+*	targets[offsets[i]] to targets[offsets[i + 1] - 1], as yielded by
+*	dynamic_sparse_graph::neighbors. Each undirected edge is listed once
+*	from each of its endpoints (a self loop twice from its vertex), and
+*	each directed edge once, from the vertex it leads from. edges holds
+*	the edge connecting a vertex to the neighbour at the same position
+*	in targets.\n
+*	The snapshot points into the graph it was made from; it must not
+*	outlive that graph, and it is invalidated by any addition or removal
+*	of vertices and edges. Vertex and edge data may still be altered
+*	through the snapshot.
+*/
+template <typename K, typename V, typename E, typename P = graph_policy<> >
+struct compact_graph
+{
+	/** \brief The policy of the graph the snapshot was made from.
+	*/
+	typedef P policy;
+
+	/** \brief Retrieve the number of vertices in the snapshot.
+	*	\return the number of vertices in the snapshot.
+	*/
+	size_t get_size() const
+	{
+		return vertices.size();
+	}
+	/** \brief Retrieve the number of neighbours of a vertex.
+	*	\param id is the dense id of the vertex.
+	*	\return the number of neighbours of the vertex.
+	*/
+	size_t get_degree(size_t id) const
+	{
+		return offsets[id + 1] - offsets[id];
+	}
+
+	/** \brief The key of each vertex, indexed by dense id.
+	*/
+	std::vector<K> keys;
+	/** \brief The address of each vertex, indexed by dense id.
+	*/
+	std::vector<vertex<V, E, P>*> vertices;
+	/** \brief The position in targets of each vertex's first neighbour.
+	*
+	*	This vector holds get_size() + 1 entries, the last of which is
+	*	the size of targets.
+	*/
+	std::vector<size_t> offsets;
+	/** \brief The dense ids of the neighbours of every vertex.
+	*/
+	std::vector<size_t> targets;
+	/** \brief The edge leading to each entry of targets.
+	*/
+	std::vector<edge<V, E, P>*> edges;
+};
+
+/** \brief Make a compressed sparse row snapshot of a graph.
+*	\param graph is the graph to take a snapshot of.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the snapshot of the graph.
+*
+*	Dense ids follow the iteration order of the graph. The adjacency of
+*	each vertex is translated to dense ids in parallel. Any policy is
+*	accepted; the adjacency is read through neighbors(), so a directed
+*	graph gives the out-neighbours of each vertex.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+compact_graph<K, V, E, P> make_compact_graph(const dynamic_sparse_graph<K, H, V, E, P>& graph, size_t thread_count = 0)
+{
+	compact_graph<K, V, E, P> compact;
+
+	size_t vertex_count = graph.get_size();
+
+	compact.keys.reserve(vertex_count);
+	compact.vertices.reserve(vertex_count);
+	compact.offsets.resize(vertex_count + 1);
+
+	std::unordered_map<const vertex<V, E, P>*, size_t> ids;
+	ids.reserve(vertex_count);
+
+	// Number the vertices and find the start of each adjacency list.
+	compact.offsets[0] = 0;
+	for (auto graph_vertex : graph)
+	{
+		ids.insert(std::make_pair(graph_vertex.second, compact.vertices.size()));
+		compact.keys.push_back(graph_vertex.first);
+		compact.vertices.push_back(graph_vertex.second);
+		compact.offsets[compact.vertices.size()] = compact.offsets[compact.vertices.size() - 1] + graph.get_degree(*graph_vertex.second);
+	}
+
+	compact.targets.resize(compact.offsets[vertex_count]);
+	compact.edges.resize(compact.offsets[vertex_count]);
+
+	// Translate the adjacency lists; ids is only read from here on.
+	parallel_for(0, vertex_count, [&](size_t first, size_t last, size_t)
+	{
+		for (size_t id = first; id < last; ++id)
+		{
+			size_t position = compact.offsets[id];
+
+			for (auto neighbor : graph.neighbors(*compact.vertices[id]))
+			{
+				compact.targets[position] = ids.find(&neighbor.first)->second;
+				compact.edges[position] = &neighbor.second;
+				++position;
+			}
+		}
+	}, thread_count);
+
+	return compact;
+}
+
+#endif // COMPACT_GRAPH_H
@@ -0,0 +1,498 @@
+
+
+#ifndef CONCURRENT_GRAPH_H
+#define CONCURRENT_GRAPH_H
+
+#include "Graph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+/** \brief A vertex of a concurrent_sparse_graph.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*
+*	This is an ordinary vertex with a lock guarding its edges. Edges of
+*	a concurrent graph point to the vertex base, which the graph casts
+*	back to reach the lock.
+*/
+template <typename V, typename E>
+struct concurrent_vertex : vertex<V, E>
+{
+	/** \brief The concurrent_vertex constructor.
+	*	\param data is the vertex's data.
+	*/
+	concurrent_vertex(const V& data)
+	: vertex<V, E>(data), removed(false)
+	{
+
+	}
+
+	/** \brief Guards edges, data and removed.
+	*/
+	spinlock lock;
+	/** \brief Set once the vertex has been removed from the graph, so
+	*		   that no more edges are added to it.
+	*/
+	bool removed;
+};
+
+/** \brief A dynamic sparse graph which may be used from many threads.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam H is the type of hash generated by for K.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*	\tparam S is the number of shards of the vertex index.
+*
+*	The vertex index is split into S shards by key hash, each an
+*	unordered_map behind its own mutex, so threads working on different
+*	keys rarely meet. Each vertex's edges are guarded by a spinlock in
+*	the vertex; operations touching two vertices acquire their locks in
+*	address order, so they cannot deadlock, and no operation holds a
+*	shard mutex while it waits for a vertex lock.\n
+*	Unlike dynamic_sparse_graph, operations check for existence and
+*	report failure by returning false, since another thread may add or
+*	remove a vertex at any moment. Vertex and edge data are handed to
+*	callbacks while the relevant vertex locks are held; callbacks must
+*	not call back into the graph.\n
+*	A removed vertex is unlinked at once but its memory is only retired;
+*	another thread may still be about to lock it. Retired vertices are
+*	freed by collect(), which must only be called while no other
+*	operation is in flight, and by the destructor.
+*/
+template <typename K, typename H, typename V, typename E, size_t S = 64>
+class concurrent_sparse_graph
+{
+public:
+	/** \brief The type of key used for accessing the vertices.
+	*/
+	typedef K key_type;
+	/** \brief The type of vertex stored by the graph.
+	*/
+	typedef concurrent_vertex<V, E> vertex_type;
+	/** \brief The type of edge stored by the graph.
+	*/
+	typedef edge<V, E> edge_type;
+
+	/** \brief The default constructor.
+	*/
+	concurrent_sparse_graph()
+	: vertex_count(0)
+	{
+
+	}
+	/** \brief The destructor.
+	*
+	*	Every vertex and edge is deleted; no other thread may be using
+	*	the graph.
+	*/
+	~concurrent_sparse_graph()
+	{
+		std::vector<edge<V, E>*> old_edges;
+
+		// Each edge is gathered from its vertices[0] side before any is deleted.
+		for (auto& current : shards)
+		{
+			for (auto& shard_vertex : current.vertices)
+			{
+				for (auto old_edge : shard_vertex.second->edges)
+				{
+					if (old_edge->vertices[0] == shard_vertex.second)
+						old_edges.push_back(old_edge);
+				}
+			}
+		}
+
+		for (auto old_edge : old_edges)
+			delete old_edge;
+
+		for (auto& current : shards)
+		{
+			for (auto& shard_vertex : current.vertices)
+				delete shard_vertex.second;
+		}
+
+		collect();
+	}
+
+	concurrent_sparse_graph(const concurrent_sparse_graph&) = delete;
+	concurrent_sparse_graph& operator=(const concurrent_sparse_graph&) = delete;
+
+	/** \brief Reserves memory for the vertex index.
+	*	\param expected_vertex_count is the number of vertices that the
+	*		   graph is expected to contain.
+	*/
+	void reserve(size_t expected_vertex_count)
+	{
+		for (auto& current : shards)
+		{
+			std::lock_guard<std::mutex> guard(current.mutex);
+			current.vertices.reserve(expected_vertex_count / S + 1);
+		}
+	}
+
+	/** \brief Adds a vertex to the graph.
+	*	\param key is the key at which to store the vertex.
+	*	\param vertex_data is the data held by the vertex.
+	*	\return false if a vertex already exists at the key.
+	*/
+	bool add_vertex(const K& key, const V& vertex_data)
+	{
+		vertex_type* new_vertex = new vertex_type(vertex_data);
+
+		shard& current = get_shard(key);
+		{
+			std::lock_guard<std::mutex> guard(current.mutex);
+
+			if (!current.vertices.insert(std::make_pair(key, new_vertex)).second)
+			{
+				delete new_vertex;
+				return false;
+			}
+		}
+
+		++vertex_count;
+		return true;
+	}
+	/** \brief Adds an edge to the graph.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param edge_data is the data held by the edge.
+	*	\return false if either vertex does not exist or the keys are
+	*			equal, as the graph has no self loops.
+	*/
+	bool add_edge(const K& key_1, const K& key_2, const E& edge_data)
+	{
+		if (key_1 == key_2)
+			return false;
+
+		vertex_type* vertex_1 = find(key_1);
+		vertex_type* vertex_2 = find(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		std::array<vertex<V, E>*, 2> new_edge_vertices = { vertex_1, vertex_2 };
+		edge<V, E>* new_edge = new edge<V, E>(new_edge_vertices, edge_data);
+
+		lock_pair(vertex_1, vertex_2);
+
+		bool added = !vertex_1->removed && !vertex_2->removed;
+		if (added)
+		{
+			vertex_1->edges.push_back(new_edge);
+			vertex_2->edges.push_back(new_edge);
+		}
+
+		unlock_pair(vertex_1, vertex_2);
+
+		if (!added)
+			delete new_edge;
+
+		return added;
+	}
+
+	/** \brief Checks whether a vertex exists.
+	*	\param key is the key of the vertex.
+	*	\return true if a vertex exists at the key.
+	*/
+	bool contains(const K& key) const
+	{
+		return find(key) != nullptr;
+	}
+	/** \brief Calls a function on a vertex while holding its lock.
+	*	\param key is the key of the vertex.
+	*	\param function is called as function(vertex).
+	*	\return false if the vertex does not exist.
+	*/
+	template <typename F>
+	bool visit_vertex(const K& key, F function)
+	{
+		vertex_type* key_vertex = find(key);
+		if (key_vertex == nullptr)
+			return false;
+
+		std::lock_guard<spinlock> guard(key_vertex->lock);
+		if (key_vertex->removed)
+			return false;
+
+		function(static_cast<vertex<V, E>&>(*key_vertex));
+		return true;
+	}
+	/** \brief Calls a function on every neighbour of a vertex.
+	*	\param key is the key of the vertex.
+	*	\param function is called as function(neighbor, edge) for each
+	*		   edge of the vertex.
+	*	\return false if the vertex does not exist.
+	*
+	*	The vertex's lock is held throughout, so its edges do not change
+	*	during the call. The neighbours' locks are not held; their data
+	*	is shared with other threads.
+	*/
+	template <typename F>
+	bool for_each_neighbor(const K& key, F function)
+	{
+		vertex_type* key_vertex = find(key);
+		if (key_vertex == nullptr)
+			return false;
+
+		std::lock_guard<spinlock> guard(key_vertex->lock);
+		if (key_vertex->removed)
+			return false;
+
+		for (auto key_edge : key_vertex->edges)
+			function(*key_edge->vertices[key_edge->vertices[0] == key_vertex], *key_edge);
+
+		return true;
+	}
+	/** \brief Calls a function on the edge connecting two vertices.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param function is called as function(edge) while both vertices'
+	*		   locks are held.
+	*	\return false if there is no such edge.
+	*/
+	template <typename F>
+	bool visit_edge(const K& key_1, const K& key_2, F function)
+	{
+		vertex_type* vertex_1 = find(key_1);
+		vertex_type* vertex_2 = find(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		lock_pair(vertex_1, vertex_2);
+
+		auto edge_it = find_edge(vertex_1, vertex_2);
+		bool found = edge_it != vertex_1->edges.end();
+		if (found)
+			function(**edge_it);
+
+		unlock_pair(vertex_1, vertex_2);
+
+		return found;
+	}
+	/** \brief Retrieve the number of edges of a vertex.
+	*	\param key is the key of the vertex.
+	*	\return the number of edges of the vertex, or 0 if it does not
+	*			exist.
+	*/
+	size_t get_degree(const K& key) const
+	{
+		vertex_type* key_vertex = find(key);
+		if (key_vertex == nullptr)
+			return 0;
+
+		std::lock_guard<spinlock> guard(key_vertex->lock);
+		return key_vertex->edges.size();
+	}
+	/** \brief Retrieve the number of vertices in the graph.
+	*	\return the number of vertices in the graph.
+	*/
+	size_t get_size() const
+	{
+		return vertex_count;
+	}
+
+	/** \brief Removes a vertex and its edges from the graph.
+	*	\param key is the key corresponding to the desired vertex.
+	*	\return false if the vertex does not exist.
+	*
+	*	The vertex is first unlinked from the index and marked removed,
+	*	so that no more edges are added to it. Its edges are then removed
+	*	one at a time, locking the vertex together with each neighbour in
+	*	address order. The vertex itself is retired; see collect().
+	*/
+	bool remove_vertex(const K& key)
+	{
+		vertex_type* old_vertex;
+
+		shard& current = get_shard(key);
+		{
+			std::lock_guard<std::mutex> guard(current.mutex);
+
+			auto vertex_it = current.vertices.find(key);
+			if (vertex_it == current.vertices.end())
+				return false;
+
+			old_vertex = vertex_it->second;
+			current.vertices.erase(vertex_it);
+		}
+
+		--vertex_count;
+
+		old_vertex->lock.lock();
+		old_vertex->removed = true;
+
+		while (!old_vertex->edges.empty())
+		{
+			edge<V, E>* old_edge = old_vertex->edges.back();
+			vertex_type* connected_vertex = other(old_edge, old_vertex);
+
+			// Lock the pair in address order; the edge may go meanwhile.
+			old_vertex->lock.unlock();
+			lock_pair(old_vertex, connected_vertex);
+
+			bool owned = unlink(old_vertex, old_edge);
+			if (owned)
+				unlink(connected_vertex, old_edge);
+
+			connected_vertex->lock.unlock();
+
+			if (owned)
+				delete old_edge;
+		}
+
+		old_vertex->lock.unlock();
+
+		std::lock_guard<std::mutex> guard(retired_mutex);
+		retired.push_back(old_vertex);
+
+		return true;
+	}
+	/** \brief Removes the edge connecting two vertices.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\return false if there is no such edge.
+	*/
+	bool remove_edge(const K& key_1, const K& key_2)
+	{
+		vertex_type* vertex_1 = find(key_1);
+		vertex_type* vertex_2 = find(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		lock_pair(vertex_1, vertex_2);
+
+		edge<V, E>* old_edge = nullptr;
+		auto edge_it = find_edge(vertex_1, vertex_2);
+		if (edge_it != vertex_1->edges.end())
+		{
+			old_edge = *edge_it;
+			unlink(vertex_1, old_edge);
+			unlink(vertex_2, old_edge);
+		}
+
+		unlock_pair(vertex_1, vertex_2);
+
+		delete old_edge;
+
+		return old_edge != nullptr;
+	}
+
+	/** \brief Frees the vertices retired by remove_vertex.
+	*
+	*	No other operation may be in flight during this call.
+	*/
+	void collect()
+	{
+		std::lock_guard<std::mutex> guard(retired_mutex);
+
+		for (auto old_vertex : retired)
+			delete old_vertex;
+		retired.clear();
+	}
+
+private:
+	/** \brief A part of the vertex index, on its own cache line.
+	*/
+	struct alignas(64) shard
+	{
+		std::mutex mutex;
+		std::unordered_map<K, vertex_type*, H> vertices;
+	};
+
+	/** \brief Retrieve the shard responsible for a key.
+	*/
+	shard& get_shard(const K& key) const
+	{
+		// Spread the hash first; std::hash is the identity for integers.
+		std::uint64_t hash = std::uint64_t(H()(key)) * 0x9e3779b97f4a7c15ULL;
+
+		return shards[(hash >> 32) % S];
+	}
+	/** \brief Look up a vertex, or nullptr.
+	*/
+	vertex_type* find(const K& key) const
+	{
+		shard& current = get_shard(key);
+		std::lock_guard<std::mutex> guard(current.mutex);
+
+		auto vertex_it = current.vertices.find(key);
+		return vertex_it != current.vertices.end() ? vertex_it->second : nullptr;
+	}
+	/** \brief Retrieve the other end of an edge.
+	*/
+	static vertex_type* other(edge<V, E>* some_edge, vertex<V, E>* some_vertex)
+	{
+		return static_cast<vertex_type*>(some_edge->vertices[some_edge->vertices[0] == some_vertex]);
+	}
+	/** \brief Find the edge to vertex_2 among vertex_1's edges.
+	*/
+	static typename std::vector<edge<V, E>*>::iterator find_edge(vertex_type* vertex_1, vertex_type* vertex_2)
+	{
+		return std::find_if(vertex_1->edges.begin(), vertex_1->edges.end(), [&](edge<V, E>* candidate)
+		{
+			return other(candidate, vertex_1) == vertex_2;
+		});
+	}
+	/** \brief Remove an edge from a vertex's edges.
+	*	\return false if the vertex did not have the edge.
+	*/
+	static bool unlink(vertex_type* some_vertex, edge<V, E>* old_edge)
+	{
+		auto edge_it = std::find(some_vertex->edges.begin(), some_vertex->edges.end(), old_edge);
+		if (edge_it == some_vertex->edges.end())
+			return false;
+
+		*edge_it = some_vertex->edges.back();
+		some_vertex->edges.pop_back();
+
+		return true;
+	}
+	/** \brief Lock two vertices in address order.
+	*
+	*	A vertex passed twice is locked once, as its lock is not
+	*	recursive.
+	*/
+	static void lock_pair(vertex_type* vertex_1, vertex_type* vertex_2)
+	{
+		if (std::less<vertex_type*>()(vertex_2, vertex_1))
+			std::swap(vertex_1, vertex_2);
+
+		vertex_1->lock.lock();
+		if (vertex_2 != vertex_1)
+			vertex_2->lock.lock();
+	}
+	/** \brief Unlock two vertices locked by lock_pair.
+	*/
+	static void unlock_pair(vertex_type* vertex_1, vertex_type* vertex_2)
+	{
+		vertex_1->lock.unlock();
+		if (vertex_2 != vertex_1)
+			vertex_2->lock.unlock();
+	}
+
+	/** \brief The number of vertices contained by the graph.
+	*/
+	std::atomic<size_t> vertex_count;
+	/** \brief The shards of the vertex index.
+	*/
+	mutable std::array<shard, S> shards;
+	/** \brief Guards retired.
+	*/
+	std::mutex retired_mutex;
+	/** \brief The vertices removed since the last collect().
+	*/
+	std::vector<vertex_type*> retired;
+};
+
+#endif // CONCURRENT_GRAPH_H
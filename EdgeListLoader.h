@@ -0,0 +1,497 @@
+
+
+#ifndef EDGE_LIST_LOADER_H
+#define EDGE_LIST_LOADER_H
+
+#include "Graph.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdexcept>
+#include <type_traits>
+#include <limits>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/** \brief A key as it appears in an edge list, pointing into the file.
+*/
+struct edge_list_token
+{
+	/** \brief The first character of the key.
+	*/
+	const char* data;
+	/** \brief The number of characters in the key.
+	*/
+	size_t size;
+};
+
+/** \brief Compares two tokens by their characters.
+*/
+inline bool operator==(const edge_list_token& lhs, const edge_list_token& rhs)
+{
+	return lhs.size == rhs.size && std::equal(lhs.data, lhs.data + lhs.size, rhs.data);
+}
+
+/** \brief Hashes a token by its characters (64-bit FNV-1a).
+*/
+struct edge_list_token_hash
+{
+	size_t operator()(const edge_list_token& token) const
+	{
+		std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+		for (size_t index = 0; index < token.size; ++index)
+			hash = (hash ^ static_cast<unsigned char>(token.data[index])) * 0x100000001b3ULL;
+
+		return size_t(hash);
+	}
+};
+
+namespace edge_list_detail
+{
+	inline bool is_separator(char character)
+	{
+		return character == ' ' || character == '\t' || character == ',' || character == '\r';
+	}
+
+	/** \brief Parses a decimal integer spanning exactly [first, last).
+	*/
+	template <typename T>
+	bool parse_integer(const char* first, const char* last, T& value)
+	{
+		bool negative = false;
+
+		if (first != last && (*first == '-' || *first == '+'))
+		{
+			negative = *first == '-';
+			if (negative && !std::is_signed<T>::value)
+				return false;
+			++first;
+		}
+
+		// 19 digits always fit in 64 bits.
+		if (first == last || last - first > 19)
+			return false;
+
+		std::uint64_t magnitude = 0;
+		for (; first != last; ++first)
+		{
+			unsigned digit = unsigned(*first - '0');
+			if (digit > 9)
+				return false;
+			magnitude = magnitude * 10 + digit;
+		}
+
+		if (magnitude > std::uint64_t(std::numeric_limits<T>::max()) + (negative ? 1 : 0))
+			return false;
+
+		value = negative ? T(0 - magnitude) : T(magnitude);
+
+		return true;
+	}
+
+	/** \brief Parses a decimal floating point number spanning exactly
+	*		   [first, last).
+	*
+	*	Up to 19 significant digits are gathered into an integer which is
+	*	then scaled by a power of ten; powers up to 10^22 are exact, so the
+	*	common short weights are converted without rounding error.
+	*/
+	inline bool parse_double(const char* first, const char* last, double& value)
+	{
+		static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		bool negative = false;
+		if (first != last && (*first == '-' || *first == '+'))
+		{
+			negative = *first == '-';
+			++first;
+		}
+
+		std::uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		bool any = false;
+
+		for (; first != last && unsigned(*first - '0') <= 9; ++first, any = true)
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + unsigned(*first - '0');
+				if (mantissa > 0)
+					++digits;
+			}
+			else
+				++exponent;
+		}
+
+		if (first != last && *first == '.')
+		{
+			for (++first; first != last && unsigned(*first - '0') <= 9; ++first, any = true)
+			{
+				if (digits < 19)
+				{
+					mantissa = mantissa * 10 + unsigned(*first - '0');
+					if (mantissa > 0)
+						++digits;
+					--exponent;
+				}
+			}
+		}
+
+		if (!any)
+			return false;
+
+		if (first != last && (*first == 'e' || *first == 'E'))
+		{
+			int written = 0;
+			if (!parse_integer(first + 1, last, written))
+				return false;
+			exponent += written;
+			first = last;
+		}
+
+		if (first != last)
+			return false;
+
+		value = double(mantissa);
+		if (exponent < 0 && exponent >= -22)
+			value /= powers[-exponent];
+		else if (exponent > 0 && exponent <= 22)
+			value *= powers[exponent];
+		else if (exponent != 0)
+			value *= std::pow(10.0, exponent);
+
+		if (negative)
+			value = -value;
+
+		return true;
+	}
+}
+
+/** \brief Describes how keys of type K are read from an edge list.
+*	\tparam K is the type of key.
+*
+*	A specialization provides a token type, which is what the parallel
+*	parse produces and what keys are interned by, a hasher for it, and
+*	\code
+*	static bool parse(const char* first, const char* last, token& value);
+*	static K make_key(const token& value);
+*	\endcode
+*	Specializations are provided for integral keys, which are parsed
+*	into integers, and std::string keys, whose tokens point into the
+*	file so that each distinct key is only copied once.
+*/
+template <typename K, typename Enable = void>
+struct edge_list_key;
+
+template <typename K>
+struct edge_list_key<K, typename std::enable_if<std::is_integral<K>::value>::type>
+{
+	typedef K token;
+	typedef std::hash<K> token_hash;
+
+	static bool parse(const char* first, const char* last, token& value)
+	{
+		return edge_list_detail::parse_integer(first, last, value);
+	}
+
+	static K make_key(const token& value)
+	{
+		return value;
+	}
+};
+
+template <>
+struct edge_list_key<std::string>
+{
+	typedef edge_list_token token;
+	typedef edge_list_token_hash token_hash;
+
+	static bool parse(const char* first, const char* last, token& value)
+	{
+		value.data = first;
+		value.size = last - first;
+
+		return true;
+	}
+
+	static std::string make_key(const token& value)
+	{
+		return std::string(value.data, value.size);
+	}
+};
+
+/** \brief Converts the weight column of an edge list to edge data.
+*	\tparam E is the type of edge data, which must be constructible
+*			from double.
+*/
+template <typename E>
+struct edge_weight_cast
+{
+	E operator()(double weight) const
+	{
+		return E(weight);
+	}
+};
+
+/** \brief The figures gathered while loading an edge list.
+*/
+struct edge_list_statistics
+{
+	/** \brief Retrieve the total time spent loading.
+	*	\return the total time spent loading in seconds.
+	*/
+	double get_seconds() const
+	{
+		return parse_seconds + intern_seconds + insert_seconds;
+	}
+	/** \brief Retrieve the loading throughput in bytes.
+	*	\return the number of megabytes (10^6 bytes) loaded per second.
+	*/
+	double get_megabytes_per_second() const
+	{
+		return get_seconds() > 0.0 ? bytes / 1e6 / get_seconds() : 0.0;
+	}
+	/** \brief Retrieve the loading throughput in edges.
+	*	\return the number of edges added per second.
+	*/
+	double get_edges_per_second() const
+	{
+		return get_seconds() > 0.0 ? edges / get_seconds() : 0.0;
+	}
+
+	/** \brief The size of the file in bytes.
+	*/
+	size_t bytes;
+	/** \brief The number of edges added to the graph.
+	*/
+	size_t edges;
+	/** \brief The number of vertices added to the graph.
+	*/
+	size_t vertices;
+	/** \brief The number of lines skipped because they joined a vertex
+	*		   to itself in a graph without self loops.
+	*/
+	size_t self_loops;
+	/** \brief The time spent reading and parsing the file.
+	*/
+	double parse_seconds;
+	/** \brief The time spent mapping keys to vertices.
+	*/
+	double intern_seconds;
+	/** \brief The time spent creating the edges.
+	*/
+	double insert_seconds;
+};
+
+/** \brief Adds the edges of a text edge list to a graph.
+*	\param graph is the graph to add to.
+*	\param path is the path of the edge list.
+*	\param edge_data is called as edge_data(weight) to make the data of
+*		   each edge; weight is 1 for lines without a weight column.
+*	\param vertex_data is the data given to vertices which are added.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\param chunk_size is the approximate number of bytes parsed as a
+*		   unit by one thread.
+*	\return the figures gathered while loading.
+*
+*	Each line holds two keys and an optional weight, separated by
+*	spaces, tabs or commas; blank lines and lines starting with '#' or
+*	'%' are skipped. Unless the policy of the graph allows self loops,
+*	lines joining a vertex to itself are counted and skipped. Vertices
+*	which are not in the graph yet are added; in a directed graph each
+*	edge leads from the first key of its line to the second.\n
+*	The file is memory-mapped and split into chunks at line boundaries,
+*	and the chunks are parsed in parallel (see edge_list_key). The keys
+*	are then interned, so that each distinct key is looked up in or
+*	added to the graph once, and the edges are added as one batch with
+*	add_edges, so in a multigraph they are built in a single block and
+*	the adjacency list of every vertex grows once. A std::runtime_error
+*	giving the byte
+*	offset of the first malformed line is thrown before the graph is
+*	modified.
+*/
+template <typename K, typename H, typename V, typename E, typename P, typename F = edge_weight_cast<E> >
+edge_list_statistics load_edge_list(dynamic_sparse_graph<K, H, V, E, P>& graph, const std::string& path, F edge_data = F(), const V& vertex_data = V(),
+	size_t thread_count = 0, size_t chunk_size = 1 << 22)
+{
+	typedef edge_list_key<K> key_traits;
+	typedef typename key_traits::token token;
+	typedef std::chrono::steady_clock clock;
+
+	struct record
+	{
+		token first;
+		token second;
+		double weight;
+	};
+
+	struct chunk
+	{
+		const char* first;
+		const char* last;
+		std::vector<record> records;
+		size_t self_loops;
+		const char* error;
+	};
+
+	edge_list_statistics statistics = edge_list_statistics();
+
+	clock::time_point start = clock::now();
+
+	mapped_file file(path);
+	statistics.bytes = file.size();
+
+	const char* begin = file.data();
+	const char* end = begin + file.size();
+
+	// Split the file into chunks which end just after a line break.
+	std::vector<chunk> chunks;
+	for (const char* first = begin; first != end; )
+	{
+		const char* last = end - first > std::ptrdiff_t(chunk_size) ? first + chunk_size : end;
+		while (last != end && last[-1] != '\n')
+			++last;
+
+		chunk new_chunk = { first, last, std::vector<record>(), 0, nullptr };
+		chunks.push_back(new_chunk);
+
+		first = last;
+	}
+
+	parallel_for(0, chunks.size(), [&](size_t chunk_first, size_t chunk_last, size_t)
+	{
+		for (size_t chunk_index = chunk_first; chunk_index < chunk_last; ++chunk_index)
+		{
+			chunk& current = chunks[chunk_index];
+			current.records.reserve((current.last - current.first) / 16);
+
+			for (const char* line = current.first; line != current.last && current.error == nullptr; )
+			{
+				const char* line_end = line;
+				while (line_end != current.last && *line_end != '\n')
+					++line_end;
+
+				// Gather up to four fields; a fourth means the line is malformed.
+				const char* fields[4][2];
+				size_t field_count = 0;
+
+				for (const char* cursor = line; cursor != line_end && field_count < 4; )
+				{
+					while (cursor != line_end && edge_list_detail::is_separator(*cursor))
+						++cursor;
+					if (cursor == line_end)
+						break;
+
+					fields[field_count][0] = cursor;
+					while (cursor != line_end && !edge_list_detail::is_separator(*cursor))
+						++cursor;
+					fields[field_count][1] = cursor;
+
+					++field_count;
+				}
+
+				bool comment = field_count > 0 && (*fields[0][0] == '#' || *fields[0][0] == '%');
+
+				if (field_count > 0 && !comment)
+				{
+					record new_record;
+					new_record.weight = 1.0;
+
+					if (field_count < 2 || field_count > 3
+						|| !key_traits::parse(fields[0][0], fields[0][1], new_record.first)
+						|| !key_traits::parse(fields[1][0], fields[1][1], new_record.second)
+						|| (field_count == 3 && !edge_list_detail::parse_double(fields[2][0], fields[2][1], new_record.weight)))
+					{
+						current.error = line;
+					}
+					else if (!P::self_loops && new_record.first == new_record.second)
+						++current.self_loops;
+					else
+						current.records.push_back(new_record);
+				}
+
+				line = line_end != current.last ? line_end + 1 : line_end;
+			}
+		}
+	}, thread_count, 1);
+
+	for (auto& current : chunks)
+	{
+		if (current.error != nullptr)
+			throw std::runtime_error("load_edge_list: malformed line at byte " + std::to_string(current.error - begin) + " of " + path);
+		statistics.self_loops += current.self_loops;
+	}
+
+	clock::time_point parsed = clock::now();
+
+	// Map every distinct key to a vertex.
+	std::unordered_map<token, size_t, typename key_traits::token_hash> ids;
+	std::vector<vertex<V, E, P>*> interned;
+
+	size_t record_count = 0;
+	for (auto& current : chunks)
+		record_count += current.records.size();
+
+	std::vector<std::array<size_t, 2> > endpoints;
+	std::vector<E> all_edge_data;
+	endpoints.reserve(record_count);
+	all_edge_data.reserve(record_count);
+
+	auto intern = [&](const token& key_token) -> size_t
+	{
+		auto id_it = ids.find(key_token);
+		if (id_it != ids.end())
+			return id_it->second;
+
+		K key = key_traits::make_key(key_token);
+		vertex<V, E, P>* key_vertex = graph.find_vertex(key);
+
+		if (key_vertex == nullptr)
+		{
+			key_vertex = &graph.add_vertex(key, vertex_data);
+			++statistics.vertices;
+		}
+
+		ids.insert(std::make_pair(key_token, interned.size()));
+		interned.push_back(key_vertex);
+
+		return interned.size() - 1;
+	};
+
+	for (auto& current_chunk : chunks)
+	{
+		for (auto& current : current_chunk.records)
+		{
+			std::array<size_t, 2> ends = { intern(current.first), intern(current.second) };
+			endpoints.push_back(ends);
+			all_edge_data.push_back(edge_data(current.weight));
+		}
+	}
+
+	clock::time_point interned_time = clock::now();
+
+	size_t old_edge_count = graph.get_edge_count();
+	graph.add_edges(interned, endpoints, all_edge_data, thread_count);
+	statistics.edges = graph.get_edge_count() - old_edge_count;
+
+	clock::time_point inserted = clock::now();
+
+	statistics.parse_seconds = std::chrono::duration<double>(parsed - start).count();
+	statistics.intern_seconds = std::chrono::duration<double>(interned_time - parsed).count();
+	statistics.insert_seconds = std::chrono::duration<double>(inserted - interned_time).count();
+
+	return statistics;
+}
+
+#endif // EDGE_LIST_LOADER_H
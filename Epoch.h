@@ -0,0 +1,242 @@
+
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/** \brief Epoch-based reclamation of memory shared with lock-free readers.
+*
+*	Readers enter the domain with an epoch_guard before following any
+*	shared pointer and leave it when done. Writers unlink an object so
+*	that no new reader can reach it and then retire it; the object is
+*	deleted once every reader which might still hold it has left.\n
+*	The global epoch advances when every reader inside the domain has
+*	observed the current one, and an object retired in epoch e is
+*	deleted once the global epoch reaches e + 2. Entering and leaving
+*	take a few atomic operations and never wait for a writer.\n
+*	Readers announce themselves in a fixed set of slots; if more
+*	readers than slots are inside at once, the extra ones wait for a
+*	free slot.
+*/
+class epoch_domain
+{
+public:
+	/** \brief The epoch_domain constructor.
+	*	\param slot_count is the number of readers which may be inside
+	*		   the domain at once.
+	*	\param reclaim_interval is the number of retirements after which
+	*		   reclamation is attempted.
+	*/
+	epoch_domain(size_t slot_count = 128, size_t reclaim_interval = 64)
+	: slots(new slot[slot_count]), slot_count(slot_count), reclaim_interval(reclaim_interval), epoch(1)
+	{
+		for (size_t i = 0; i < slot_count; ++i)
+			slots[i].epoch.store(0);
+	}
+	/** \brief The destructor.
+	*
+	*	Every retired object is deleted; no reader may be inside.
+	*/
+	~epoch_domain()
+	{
+		for (auto& entry : retired)
+			entry.deleter(entry.object);
+	}
+
+	epoch_domain(const epoch_domain&) = delete;
+	epoch_domain& operator=(const epoch_domain&) = delete;
+
+	/** \brief Announces a reader.
+	*	\return the slot to pass to leave.
+	*
+	*	Prefer epoch_guard to calling this directly.
+	*/
+	size_t enter()
+	{
+		size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % slot_count;
+
+		for (std::uint64_t expected = 0; ; expected = 0)
+		{
+			std::uint64_t current = epoch.load();
+			if (slots[index].epoch.compare_exchange_strong(expected, current))
+			{
+				// The epoch may have moved on before the slot was claimed.
+				while (current != epoch.load())
+				{
+					current = epoch.load();
+					slots[index].epoch.store(current);
+				}
+
+				return index;
+			}
+
+			if (++index == slot_count)
+			{
+				index = 0;
+				std::this_thread::yield();
+			}
+		}
+	}
+	/** \brief Withdraws a reader.
+	*	\param index is the slot returned by enter.
+	*/
+	void leave(size_t index)
+	{
+		slots[index].epoch.store(0);
+	}
+
+	/** \brief Hands an unlinked object over for deferred deletion.
+	*	\param object is the object; no new reader may be able to reach
+	*		   it, though current readers may still hold it.
+	*
+	*	The object is deleted with delete once no reader can hold it.
+	*/
+	template <typename T>
+	void retire(T* object)
+	{
+		if (object == nullptr)
+			return;
+
+		bool due;
+		{
+			std::lock_guard<std::mutex> guard(retired_mutex);
+
+			retired.push_back(retired_object { epoch.load(), const_cast<void*>(static_cast<const void*>(object)), &delete_object<T> });
+			due = ++retired_since_reclaim >= reclaim_interval;
+		}
+
+		if (due)
+			reclaim();
+	}
+	/** \brief Advances the epoch if possible and deletes every retired
+	*		   object which no reader can hold any more.
+	*/
+	void reclaim()
+	{
+		std::vector<retired_object> expired;
+		{
+			std::lock_guard<std::mutex> guard(retired_mutex);
+			retired_since_reclaim = 0;
+
+			std::uint64_t current = epoch.load();
+
+			bool observed = true;
+			for (size_t i = 0; i < slot_count && observed; ++i)
+			{
+				std::uint64_t reader = slots[i].epoch.load();
+				observed = reader == 0 || reader == current;
+			}
+
+			if (observed)
+				epoch.compare_exchange_strong(current, current + 1);
+
+			std::uint64_t safe = epoch.load();
+
+			size_t kept = 0;
+			for (auto& entry : retired)
+			{
+				if (entry.epoch + 2 <= safe)
+					expired.push_back(entry);
+				else
+					retired[kept++] = entry;
+			}
+			retired.resize(kept);
+		}
+
+		for (auto& entry : expired)
+			entry.deleter(entry.object);
+	}
+
+private:
+	/** \brief A reader's announcement, padded to its own cache line.
+	*
+	*	Padding rather than alignas keeps new[] valid before C++17.
+	*/
+	struct slot
+	{
+		/** \brief The epoch observed by the reader, or 0 if free.
+		*/
+		std::atomic<std::uint64_t> epoch;
+		char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+	};
+	/** \brief An object awaiting deletion.
+	*/
+	struct retired_object
+	{
+		std::uint64_t epoch;
+		void* object;
+		void (*deleter)(void*);
+	};
+
+	template <typename T>
+	static void delete_object(void* object)
+	{
+		delete static_cast<T*>(object);
+	}
+
+	/** \brief The reader slots.
+	*/
+	std::unique_ptr<slot[]> slots;
+	/** \brief The number of reader slots.
+	*/
+	size_t slot_count;
+	/** \brief The number of retirements between reclamations.
+	*/
+	size_t reclaim_interval;
+	/** \brief The global epoch; 0 is reserved for free slots.
+	*/
+	std::atomic<std::uint64_t> epoch;
+	/** \brief Guards retired and retired_since_reclaim.
+	*/
+	std::mutex retired_mutex;
+	/** \brief The objects awaiting deletion.
+	*/
+	std::vector<retired_object> retired;
+	/** \brief The number of retirements since the last reclamation.
+	*/
+	size_t retired_since_reclaim = 0;
+};
+
+/** \brief Keeps a reader inside an epoch_domain for its lifetime.
+*/
+class epoch_guard
+{
+public:
+	/** \brief The epoch_guard constructor.
+	*	\param domain is the domain to enter.
+	*/
+	explicit epoch_guard(epoch_domain& domain)
+	: domain(domain), index(domain.enter())
+	{
+
+	}
+	/** \brief The destructor.
+	*
+	*	The reader leaves the domain.
+	*/
+	~epoch_guard()
+	{
+		domain.leave(index);
+	}
+
+	epoch_guard(const epoch_guard&) = delete;
+	epoch_guard& operator=(const epoch_guard&) = delete;
+
+private:
+	/** \brief The domain entered.
+	*/
+	epoch_domain& domain;
+	/** \brief The slot claimed.
+	*/
+	size_t index;
+};
+
+#endif // EPOCH_H
@@ -5,24 +5,169 @@
 
 #include <vector>
 #include <array>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <cassert>
 #include <algorithm>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <stdexcept>
 
-template <typename V, typename E>
+#include "SmallVector.h"
+#include "Parallel.h"
+#include "VertexIndex.h"
+
+/** \brief The compile-time options of a graph.
+*	\tparam D is whether edges are directed.
+*	\tparam M is whether two vertices may be connected by several edges.
+*	\tparam L is whether an edge may connect a vertex to itself.
+*	\tparam N is whether adjacency entries hold the neighbour inline.
+*	\tparam C is the number of adjacency entries held inside a vertex.
+*	\tparam I selects the map from keys to vertices (see VertexIndex.h).
+*
+*	A directed edge leads from its vertices[0] to its vertices[1]. The
+*	vertices of a directed graph keep their outgoing and incoming edges
+*	apart, so a traversal in either direction touches only the edges
+*	which go that way.\n
+*	The checks each option calls for are compiled in only when it is
+*	chosen. The defaults are those of the original graph: multi-edges
+*	are not looked for, so adding an edge costs no search, and self
+*	loops are only asserted against. A simple graph (M false) searches
+*	the first vertex's edges on every add_edge.\n
+*	With N, each entry of a vertex's edges is an adjacency_entry holding
+*	the neighbour beside the edge, so visiting the neighbours takes one
+*	dependent load per neighbour instead of two, at the cost of a
+*	pointer more per entry.\n
+*	With C greater than 0, edge lists are small_vectors which keep their
+*	first C entries inside the vertex, so vertices of degree up to C
+*	need no allocation besides their own.\n
+*	I is hashed_index, a std::unordered_map, by default; with
+*	extendible_index the index grows a shard at a time instead of
+*	rehashing every key at once, and with direct_index integral keys
+*	from 0 up index an array of vertices without hashing.\n
+*	The functions of the other headers which take a graph, such as
+*	make_compact_graph and save_graph, accept any policy; the few which
+*	need an undirected graph say so and fail to compile otherwise.
+*/
+template <bool D = false, bool M = true, bool L = false, bool N = false, size_t C = 0, typename I = hashed_index>
+struct graph_policy
+{
+	/** \brief Whether edges are directed.
+	*/
+	static const bool directed = D;
+	/** \brief Whether parallel edges are allowed.
+	*/
+	static const bool multigraph = M;
+	/** \brief Whether self loops are allowed.
+	*/
+	static const bool self_loops = L;
+	/** \brief Whether adjacency entries hold the neighbour inline.
+	*/
+	static const bool inline_neighbors = N;
+	/** \brief The number of adjacency entries held inside a vertex.
+	*/
+	static const size_t inline_capacity = C;
+	/** \brief The selector of the vertex index.
+	*/
+	typedef I index;
+};
+
+template <typename V, typename E, typename P = graph_policy<> >
+struct vertex;
+template <typename V, typename E, typename P = graph_policy<> >
 struct edge;
 
+/** \brief An entry of a vertex's edges holding the neighbour inline.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*	\tparam P is the graph's policy.
+*
+*	The edge is still allocated, since both of its vertices share its
+*	data; only the neighbour is copied into the entry.
+*/
+template <typename V, typename E, typename P>
+struct adjacency_entry
+{
+	/** \brief The vertex at the other end of the edge.
+	*/
+	vertex<V, E, P>* neighbor;
+	/** \brief The edge itself.
+	*/
+	edge<V, E, P>* connecting_edge;
+};
+
+/** \brief The container of a vertex's edges.
+*	\tparam T is the type of adjacency entry.
+*	\tparam C is the number of entries held inline, or 0 for none.
+*/
+template <typename T, size_t C>
+struct vertex_edge_list
+{
+	typedef small_vector<T, C> type;
+};
+
+/** \brief The container of a vertex's edges, without inline entries.
+*/
+template <typename T>
+struct vertex_edge_list<T, 0>
+{
+	typedef std::vector<T> type;
+};
+
+/** \brief The edges of a vertex, as kept by the graph's policy.
+*	\tparam T is the type of adjacency entry.
+*	\tparam D is whether edges are directed.
+*	\tparam C is the number of entries held inline in each list.
+*/
+template <typename T, bool D, size_t C = 0>
+struct vertex_edges;
+
+/** \brief The edges of a vertex of an undirected graph.
+*/
+template <typename T, size_t C>
+struct vertex_edges<T, false, C>
+{
+	/** \brief The container of a vertex's edges.
+	*/
+	typedef typename vertex_edge_list<T, C>::type edge_list;
+
+	/** \brief The edges connected to this vertex.
+	*/
+	edge_list edges;
+};
+
+/** \brief The edges of a vertex of a directed graph.
+*/
+template <typename T, size_t C>
+struct vertex_edges<T, true, C>
+{
+	/** \brief The container of a vertex's edges.
+	*/
+	typedef typename vertex_edge_list<T, C>::type edge_list;
+
+	/** \brief The edges leading from this vertex.
+	*/
+	edge_list out_edges;
+	/** \brief The edges leading to this vertex.
+	*/
+	edge_list in_edges;
+};
+
 /** \brief A vertex of a graph.
 *	\tparam V is the type of vertex data.
 *	\tparam E is the type of edge data.
+*	\tparam P is the graph's policy.
 *
 *	This struct is a container of edges and data specific to the vertex.
 *	Although the vertex's edges are publicly accessible, they are only
-*	to be removed/added through the containing graph's methods.
+*	to be removed/added through the containing graph's methods. They are
+*	held in edges, or in out_edges and in_edges if the graph is directed,
+*	as edge pointers or, if the policy says so, adjacency_entry objects.
 */
-template <typename V, typename E>
-struct vertex
+template <typename V, typename E, typename P>
+struct vertex : vertex_edges<typename std::conditional<P::inline_neighbors, adjacency_entry<V, E, P>, edge<V, E, P>*>::type, P::directed, P::inline_capacity>
 {
 	/** \brief The Vertex constructor.
 	*	\param data is the vertex's data.
@@ -33,9 +178,6 @@ struct vertex
 		;
 	}
 
-	/** \brief The edges connected to this vertex.
-	*/
-	std::vector<edge<V, E>*> edges;
 	/** \brief The data held by this vertex.
 	*/
 	V data;
@@ -44,38 +186,200 @@ struct vertex
 /** \brief An edge of a graph.
 *	\tparam V is the type of vertex data.
 *	\tparam E is the type of edge data.
+*	\tparam P is the graph's policy.
 *
 *	This struct is a container of vertices and data specific to the edge.
 *	Although the edge's vertices are publicly accessible and not const,
 *	this is only to allow for altering vertex data; do not change the
 *	addresses of the pointers.
 */
-template <typename V, typename E>
+template <typename V, typename E, typename P>
 struct edge
 {
 	/** \brief The Edge constructor.
 	*	\param vertices are the two vertices which this edge connects.
 	*	\param data is the edge's data
 	*/
-	edge(const std::array<vertex<V, E>*, 2>& vertices, const E& data)
+	edge(const std::array<vertex<V, E, P>*, 2>& vertices, const E& data)
 	: vertices(vertices), data(data)
 	{
 
 	}
 
-	/** \brief The vertices connected by this edge.
+	/** \brief The vertices connected by this edge; a directed edge
+	*		   leads from the first to the second.
 	*/
-	std::array<vertex<V, E>*, 2> vertices;
+	std::array<vertex<V, E, P>*, 2> vertices;
 	/** \brief The data held by this vertex.
 	*/
 	E data;
 };
 
+/** \brief Measures the heap memory owned by a value.
+*	\tparam T is the type of value.
+*
+*	dynamic_sparse_graph::memory_usage counts the objects it allocates
+*	itself; the memory that keys and data own beyond their own size is
+*	found through this struct. The primary template reports none, which
+*	is right for any type that owns no memory. Other types may
+*	specialize it, providing
+*	\code
+*	static size_t get(const T& value);
+*	\endcode
+*	Specializations for std::string and std::vector are provided.
+*/
+template <typename T>
+struct payload_memory
+{
+	static size_t get(const T&)
+	{
+		return 0;
+	}
+};
+
+/** \brief Measures the characters of a string which are not stored
+*		   within the string object itself.
+*/
+template <>
+struct payload_memory<std::string>
+{
+	static size_t get(const std::string& value)
+	{
+		const char* characters = value.data();
+		const char* object = reinterpret_cast<const char*>(&value);
+
+		// Short strings are held inside the object.
+		if (characters >= object && characters < object + sizeof(value))
+			return 0;
+
+		return value.capacity() + 1;
+	}
+};
+
+/** \brief Measures the buffer of a vector and what its elements own.
+*/
+template <typename T, typename A>
+struct payload_memory<std::vector<T, A> >
+{
+	static size_t get(const std::vector<T, A>& value)
+	{
+		size_t bytes = value.capacity() * sizeof(T);
+		for (auto& element : value)
+			bytes += payload_memory<T>::get(element);
+
+		return bytes;
+	}
+};
+
+/** \brief The memory used by a dynamic_sparse_graph, in bytes.
+*
+*	The figures are the sizes requested from the allocator; the
+*	allocator's own overhead per block is not included, and the index is
+*	estimated from the bucket and node layout of a typical unordered_map.
+*/
+struct graph_memory_usage
+{
+	/** \brief The number of vertices.
+	*/
+	size_t vertex_count;
+	/** \brief The number of edges.
+	*/
+	size_t edge_count;
+	/** \brief The vertex index: buckets, nodes and what the keys own.
+	*/
+	size_t index;
+	/** \brief The vertex objects, including inline edge entries.
+	*/
+	size_t vertices;
+	/** \brief The edge objects.
+	*/
+	size_t edges;
+	/** \brief The heap buffers of the vertices' edge lists.
+	*/
+	size_t adjacency;
+	/** \brief The unused part of adjacency, left by growth or removals.
+	*/
+	size_t adjacency_slack;
+	/** \brief The memory owned by vertex data, found through
+	*		   payload_memory.
+	*/
+	size_t vertex_payload;
+	/** \brief The memory owned by edge data, found through
+	*		   payload_memory.
+	*/
+	size_t edge_payload;
+
+	/** \brief Retrieve the total memory used.
+	*	\return the sum of every figure but adjacency_slack, which is
+	*			part of adjacency.
+	*/
+	size_t get_total() const
+	{
+		return index + vertices + edges + adjacency + vertex_payload + edge_payload;
+	}
+};
+
+/** \brief The distribution of the degrees of a dynamic_sparse_graph.
+*/
+struct graph_degree_statistics
+{
+	/** \brief The number of vertices.
+	*/
+	size_t vertex_count;
+	/** \brief The smallest degree, or 0 if there are no vertices.
+	*/
+	size_t min_degree;
+	/** \brief The largest degree, or 0 if there are no vertices.
+	*/
+	size_t max_degree;
+	/** \brief The average degree, or 0 if there are no vertices.
+	*/
+	double mean_degree;
+	/** \brief The number of vertices of each degree, indexed by degree
+	*		   from 0 to max_degree.
+	*/
+	std::vector<size_t> histogram;
+};
+
+/** \brief A pair of iterators usable in a range-based for loop.
+*	\tparam I is the type of iterator.
+*/
+template <typename I>
+class iterator_range
+{
+public:
+	/** \brief The iterator_range constructor.
+	*	\param first is the first iterator of the range.
+	*	\param last is the iterator past the end of the range.
+	*/
+	iterator_range(I first, I last)
+	: first(first), last(last)
+	{
+
+	}
+
+	I begin() const { return first; }
+	I end() const { return last; }
+
+	/** \brief Checks whether the range is empty.
+	*	\return true if the range is empty.
+	*/
+	bool empty() const
+	{
+		return first == last;
+	}
+
+private:
+	I first;
+	I last;
+};
+
 /** \brief A mathematical graph object.
 *	\tparam K is the type of key used for accesing the vertices.
 *	\tparam H is the type of hash generated by for K.
 *	\tparam V is the type of vertex data.
 *	\tparam E is the type of edge data.
+*	\tparam P is the graph's policy, a graph_policy.
 *
 *	The name dynamic_sparse_graph was chosen to indicate the features
 *	and optimal usage for this object; the graph is dynamic because it
@@ -86,7 +390,7 @@ struct edge
 *	This class is not responsible for managing any heap memory which its
 *	vertices and edges might point to.
 */
-template <typename K, typename H, typename V, typename E>
+template <typename K, typename H, typename V, typename E, typename P = graph_policy<> >
 class dynamic_sparse_graph
 {
 	/** \brief The output-bitshift operator.
@@ -100,11 +404,12 @@ class dynamic_sparse_graph
 	friend std::ostream& operator<<(std::ostream& os, const dynamic_sparse_graph& graph)
 	{
 		os << "Graph " << &graph << ":\n";
-		for (auto vertex : graph.vertices)
+		for (auto vertex : graph.vertex_index)
 		{
 			os << "  Vertex " << vertex.second << ":\n";
-			for (auto edge : vertex.second->edges)
+			for (auto& entry : get_edges(*vertex.second, directedness()))
 			{
+				auto edge = get_edge_of(entry);
 				os << "    Edge " << edge << ": " << edge->vertices.at(0) << " to " << edge->vertices.at(1) << "\n";
 			}
 		}
@@ -120,65 +425,234 @@ class dynamic_sparse_graph
 	*	In particular, both graphs are left in an assignable/destructable
 	*	state.
 	*/
-	friend void swap(dynamic_sparse_graph<K, H, V, E>& lhs, dynamic_sparse_graph<K, H, V, E>& rhs)
+	friend void swap(dynamic_sparse_graph& lhs, dynamic_sparse_graph& rhs)
 	{
 		size_t temp = lhs.vertex_count;
 		lhs.vertex_count = rhs.vertex_count;
 		rhs.vertex_count = temp;
 
-		lhs.vertices.swap(rhs.vertices);
+		temp = lhs.edge_count;
+		lhs.edge_count = rhs.edge_count;
+		rhs.edge_count = temp;
+
+		lhs.vertex_index.swap(rhs.vertex_index);
+		lhs.pools.swap(rhs.pools);
 	}
 
 public:
-	/** \brief The default constructor.
+	/** \brief The type of key used for accessing the vertices.
+	*/
+	typedef K key_type;
+	/** \brief The type of vertex stored by the graph.
+	*/
+	typedef vertex<V, E, P> vertex_type;
+	/** \brief The type of edge stored by the graph.
+	*/
+	typedef edge<V, E, P> edge_type;
+	/** \brief The map from keys to vertices chosen by the policy.
+	*/
+	typedef typename P::index::template rebind<K, vertex<V, E, P>*, H>::type index_type;
+	/** \brief The iterator used to traverse the graph's vertices.
 	*
-	*	vertex_count is initialized to 0.
+	*	Dereferencing the iterator yields a pair of a vertex's key and
+	*	a pointer to the vertex.
 	*/
-	dynamic_sparse_graph()
-	: vertex_count(0)
+	typedef typename index_type::const_iterator const_iterator;
+
+	/** \brief The iterator over the neighbours of a vertex.
+	*
+	*	Dereferencing the iterator yields a pair of the neighbour and
+	*	the edge leading to it. The neighbour is read from the adjacency
+	*	entry when the policy inlines it, and otherwise picked from the
+	*	edge's vertices without a branch.
+	*/
+	class neighbor_iterator
 	{
-		;
-	}
-	/** \brief The copy constructor.
-	*	\param rhs is the graph to copy.
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef std::pair<vertex<V, E, P>&, edge<V, E, P>&> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef value_type reference;
+		typedef void pointer;
+
+		neighbor_iterator(typename vertex<V, E, P>::edge_list::iterator entry_it, vertex<V, E, P>* some_vertex)
+		: entry_it(entry_it), some_vertex(some_vertex)
+		{
+
+		}
+
+		value_type operator*() const
+		{
+			return value_type(*get_neighbor_of(*entry_it, some_vertex), *get_edge_of(*entry_it));
+		}
+		neighbor_iterator& operator++()
+		{
+			++entry_it;
+			return *this;
+		}
+		neighbor_iterator operator++(int)
+		{
+			neighbor_iterator old = *this;
+			++entry_it;
+			return old;
+		}
+		bool operator==(const neighbor_iterator& rhs) const { return entry_it == rhs.entry_it; }
+		bool operator!=(const neighbor_iterator& rhs) const { return entry_it != rhs.entry_it; }
+
+	private:
+		typename vertex<V, E, P>::edge_list::iterator entry_it;
+		vertex<V, E, P>* some_vertex;
+	};
+	/** \brief The iterator over the vertices of the graph.
 	*
-	*	A first loop iterates through the rhs graph to copy its vertices.
-	*	A second loop iterates through the rhs graph to copy its edges.\n
-	*	vertex_count is initialized to 0 prior to these loops, however.
+	*	Dereferencing the iterator yields a vertex; it follows the
+	*	order of const_iterator.
 	*/
-	dynamic_sparse_graph(const dynamic_sparse_graph<K,H,V,E>& rhs)
-	: vertex_count(0)
+	class vertex_iterator
 	{
-		// Add the rhs vertices to this graph.
-		for (auto rhs_vertex : rhs.vertices)
-			this->add_vertex(rhs_vertex.first, rhs_vertex.second->data);
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef vertex<V, E, P> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef vertex<V, E, P>& reference;
+		typedef vertex<V, E, P>* pointer;
+
+		vertex_iterator()
+		{
+
+		}
+		explicit vertex_iterator(const_iterator vertex_it)
+		: vertex_it(vertex_it)
+		{
+
+		}
+
+		vertex<V, E, P>& operator*() const { return *vertex_it->second; }
+		vertex<V, E, P>* operator->() const { return vertex_it->second; }
+		vertex_iterator& operator++()
+		{
+			++vertex_it;
+			return *this;
+		}
+		vertex_iterator operator++(int)
+		{
+			vertex_iterator old = *this;
+			++vertex_it;
+			return old;
+		}
+		bool operator==(const vertex_iterator& rhs) const { return vertex_it == rhs.vertex_it; }
+		bool operator!=(const vertex_iterator& rhs) const { return vertex_it != rhs.vertex_it; }
+
+	private:
+		const_iterator vertex_it;
+	};
+	/** \brief The iterator over the edges of the graph.
+	*
+	*	Every edge is visited exactly once, from the adjacency of its
+	*	vertices[0], so no record of the edges already seen is kept.
+	*/
+	class edge_iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef edge<V, E, P> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef edge<V, E, P>& reference;
+		typedef edge<V, E, P>* pointer;
+
+		edge_iterator()
+		{
+
+		}
+		edge_iterator(const_iterator vertex_it, const_iterator vertex_end)
+		: vertex_it(vertex_it), vertex_end(vertex_end)
+		{
+			if (vertex_it != vertex_end)
+				entry_it = get_edges(*vertex_it->second, directedness()).begin();
+
+			settle();
+		}
 
-		// This object is used to track which edges have been added. Note that each edge
-		// will be visited in the following loop exactly twice (unless the user has done
-		// some nasty business with edges).
-		std::unordered_set<edge<V, E>*> rhs_edges;
+		edge<V, E, P>& operator*() const { return *get_edge_of(*entry_it); }
+		edge<V, E, P>* operator->() const { return get_edge_of(*entry_it); }
+		edge_iterator& operator++()
+		{
+			++entry_it;
+			settle();
+			return *this;
+		}
+		edge_iterator operator++(int)
+		{
+			edge_iterator old = *this;
+			++*this;
+			return old;
+		}
+		bool operator==(const edge_iterator& rhs) const
+		{
+			return vertex_it == rhs.vertex_it && (vertex_it == vertex_end || entry_it == rhs.entry_it);
+		}
+		bool operator!=(const edge_iterator& rhs) const
+		{
+			return !(*this == rhs);
+		}
 
-		for (auto rhs_vertex : rhs.vertices)
+	private:
+		/** \brief Move forward to the next entry listing its edge, if
+		*		   this one does not.
+		*/
+		void settle()
 		{
-			// Iterate through each rhs vertex's edges.
-			for (auto rhs_edge : rhs_vertex.second->edges)
+			while (vertex_it != vertex_end)
 			{
-				auto rhs_edges_it = rhs_edges.find(rhs_edge);
-				if (rhs_edges_it == rhs_edges.end()) // The rhs edge has not been visited before.
-				{
-					rhs_edges.insert(rhs_edge);
+				auto& edges = get_edges(*vertex_it->second, directedness());
 
-					// Add the rhs edge to this graph.
-					if (rhs_edge->vertices.at(0) == rhs_vertex.second)
-						this->add_edge(rhs_vertex.first, rhs.get_key(*rhs_edge->vertices.at(1)), rhs_edge->data);
-					else
-						this->add_edge(rhs_vertex.first, rhs.get_key(*rhs_edge->vertices.at(0)), rhs_edge->data);
+				for (; entry_it != edges.end(); ++entry_it)
+				{
+					if (is_listing_entry(edges, entry_it, vertex_it->second, directedness()))
+						return;
 				}
-				else // The edge has been visited before
-					rhs_edges.erase(rhs_edge); // This removal is done to speed up the set searchs.
+
+				if (++vertex_it != vertex_end)
+					entry_it = get_edges(*vertex_it->second, directedness()).begin();
 			}
 		}
 
+		const_iterator vertex_it;
+		const_iterator vertex_end;
+		typename vertex<V, E, P>::edge_list::iterator entry_it;
+	};
+
+	/** \brief The default constructor.
+	*
+	*	vertex_count and edge_count are initialized to 0.
+	*/
+	dynamic_sparse_graph()
+	: vertex_count(0), edge_count(0)
+	{
+		;
+	}
+	/** \brief The copy constructor.
+	*	\param rhs is the graph to copy.
+	*
+	*	A first loop iterates through the rhs graph to copy its vertices.
+	*	A second loop visits each rhs edge once to copy it between the
+	*	copies of its vertices, which keep its direction.\n
+	*	vertex_count and edge_count are initialized to 0 prior to these
+	*	loops, however.
+	*/
+	dynamic_sparse_graph(const dynamic_sparse_graph& rhs)
+	: vertex_count(0), edge_count(0)
+	{
+		std::unordered_map<const vertex<V, E, P>*, vertex<V, E, P>*> copies;
+		copies.reserve(rhs.vertex_count);
+		vertex_index.reserve(rhs.vertex_count);
+
+		// Add the rhs vertices to this graph.
+		for (auto rhs_vertex : rhs.vertex_index)
+			copies[rhs_vertex.second] = &this->add_vertex(rhs_vertex.first, rhs_vertex.second->data);
+
+		for (auto& rhs_edge : rhs.edges())
+			this->add_edge(*copies[rhs_edge.vertices[0]], *copies[rhs_edge.vertices[1]], rhs_edge.data);
 	}
 	/** \brief The move constructor.
 	*	\param rhs is the graph to copy.
@@ -186,7 +660,7 @@ public:
 	*	The swap function is called. As a result, the code is more
 	*	elegant but it may run slower.
 	*/
-	dynamic_sparse_graph(dynamic_sparse_graph<K, H, V, E>&& rhs)
+	dynamic_sparse_graph(dynamic_sparse_graph&& rhs)
 	: dynamic_sparse_graph()
 	{
 		swap(*this, rhs);
@@ -198,7 +672,7 @@ public:
 	*	
 	*	This function is implemented according to the copy-swap idiom.
 	*/
-	dynamic_sparse_graph& operator=(dynamic_sparse_graph<K,H,V,E> rhs)
+	dynamic_sparse_graph& operator=(dynamic_sparse_graph rhs)
 	{
 		swap(*this, rhs);
 
@@ -212,7 +686,7 @@ public:
 	*	elegant but it may run slower. This function is identical to
 	*	the ordinary assignment operator.
 	*/
-	dynamic_sparse_graph& operator=(dynamic_sparse_graph<K, H, V, E>&& rhs)
+	dynamic_sparse_graph& operator=(dynamic_sparse_graph&& rhs)
 	{
 		swap(*this, rhs);
 
@@ -221,59 +695,122 @@ public:
 
 	/**	\brief The destructor.
 	*	
-	*	While vertices exist, remove_vertex is called on the last one.
+	*	Every edge is deleted once, then every vertex; nothing is
+	*	detached from the edge lists, since they go too. This neither
+	*	searches the lists nor asks the index for its first vertex again
+	*	after each removal, which is slow for indices whose begin() has
+	*	to skip emptied parts.
 	*/
 	~dynamic_sparse_graph()
 	{
-		while (vertex_count > 0)
-			remove_vertex((--vertices.end())->first);
+		// Collect the edges first: edges() reads an edge's vertices to
+		// tell whether to list it, so none may be deleted before the end.
+		std::vector<edge<V, E, P>*> old_edges;
+		old_edges.reserve(edge_count);
+		for (auto& old_edge : edges())
+			old_edges.push_back(&old_edge);
+
+		for (auto old_edge : old_edges)
+			destroy(old_edge);
+
+		for (auto& key_vertex : vertex_index)
+			destroy(key_vertex.second);
 	}
 
-	/** \brief Reserves memory for the underlying unordered_map.
+	/** \brief Reserves memory for the vertex index.
 	*	\param expected_vertex_count is the expected number of vertices
 	*		   that the graph is expected to contain.
 	*/
 	void reserve(size_t expected_vertex_count)
 	{
-		vertices.reserve(expected_vertex_count);
+		vertex_index.reserve(expected_vertex_count);
 	}
 
 	/** \brief Adds a vertex to the graph.
 	*	\param key is the key at which to store the vertex.
 	*	\param vertex_data is the data held by the vertex.
+	*	\return the new vertex.
 	*
 	*	This function does not check for pre-existing vertices.
 	*	Memory is allocated.
 	*/
-	void add_vertex(const K& key, const V& vertex_data)
+	vertex<V, E, P>& add_vertex(const K& key, const V& vertex_data)
 	{
-		std::pair<K, vertex<V, E>*> new_pair(key, new vertex<V,E>(vertex_data));
+		std::pair<K, vertex<V, E, P>*> new_pair(key, new vertex<V, E, P>(vertex_data));
 		
-		vertices.insert(new_pair);
+		vertex_index.insert(new_pair);
 		++vertex_count;
+
+		return *new_pair.second;
 	}
 	/** \brief Adds an edge to the graph.
 	*	\param key_1 is the key corresponding to the first vertex.
 	*	\param key_2 is the key corresponding to the second vertex.
 	*	\param edge_data is the data held by the edge.
+	*	\return the new edge.
 	*
-	*	This function asserts that the key arguments are not equal and
-	*	checks that vertices do indeed exist at the input keys. Memory
-	*	is allocated.
+	*	This function asserts that the key arguments are not equal, unless
+	*	the policy allows self loops, and checks that vertices do indeed
+	*	exist at the input keys. Memory is allocated. In a directed graph
+	*	the edge leads from the first vertex to the second. In a simple
+	*	graph, an existing edge between the vertices is returned instead
+	*	and its data is left unchanged.
 	*/
-	void add_edge(const K& key_1, const K& key_2, const E& edge_data)
+	edge<V, E, P>& add_edge(const K& key_1, const K& key_2, const E& edge_data)
 	{
-		assert(key_1 != key_2);
+		assert(P::self_loops || key_1 != key_2);
+
+		return add_edge(*vertex_index.at(key_1), *vertex_index.at(key_2), edge_data);
+	}
+	/** \brief Adds an edge between two vertices of the graph.
+	*	\param vertex_1 is the first vertex.
+	*	\param vertex_2 is the second vertex.
+	*	\param edge_data is the data held by the edge.
+	*	\return the new edge.
+	*
+	*	This function asserts that the vertices are not the same, unless
+	*	the policy allows self loops, but does not check that they belong
+	*	to this graph. It saves the key lookups when the vertices are
+	*	already at hand. Memory is allocated.
+	*/
+	edge<V, E, P>& add_edge(vertex<V, E, P>& vertex_1, vertex<V, E, P>& vertex_2, const E& edge_data)
+	{
+		assert(P::self_loops || &vertex_1 != &vertex_2);
+
+		edge<V, E, P>* old_edge = find_parallel(vertex_1, vertex_2, std::integral_constant<bool, P::multigraph>());
+		if (old_edge != nullptr)
+			return *old_edge;
+
+		std::array<vertex<V, E, P>*, 2> new_edge_vertices = { &vertex_1, &vertex_2 };
 
-		vertex<V, E>* vertex_1 = vertices.at(key_1);
-		vertex<V, E>* vertex_2 = vertices.at(key_2);
+		edge<V, E, P>* new_edge = new edge<V, E, P>(new_edge_vertices, edge_data);
 
-		std::array<vertex<V, E>*, 2> new_edge_vertices = { vertex_1, vertex_2 };
+		link(new_edge, directedness());
+		++edge_count;
 
-		edge<V, E>* new_edge = new edge<V, E>(new_edge_vertices, edge_data);
+		return *new_edge;
+	}
+	/** \brief Adds many edges between vertices of the graph at once.
+	*	\param id_vertices are distinct vertices of this graph, indexed
+	*		   by the ids used in ends.
+	*	\param ends are the ids of the two vertices of each new edge.
+	*	\param edge_data holds the data of each new edge.
+	*	\param thread_count is the number of threads to use; 0 selects
+	*		   default_thread_count().
+	*
+	*	The edges are built in parallel in a single block, like that of
+	*	compact(true). The ends of the edges are radix sorted by vertex,
+	*	so each vertex's edge list grows once to take all of its new
+	*	edges and the lists are filled in parallel; each list receives
+	*	its edges in the order of ends. A simple graph adds the edges
+	*	one by one with add_edge instead, since they must be looked for.
+	*	Memory is allocated.
+	*/
+	void add_edges(const std::vector<vertex<V, E, P>*>& id_vertices, const std::vector<std::array<size_t, 2> >& ends, const std::vector<E>& edge_data, size_t thread_count = 0)
+	{
+		assert(ends.size() == edge_data.size());
 
-		vertex_1->edges.push_back(new_edge);
-		vertex_2->edges.push_back(new_edge);
+		add_edges(id_vertices, ends, edge_data, thread_count, std::integral_constant<bool, P::multigraph>());
 	}
 
 	/** \brief Retrieve the vertex at the given input.
@@ -282,38 +819,54 @@ public:
 	*
 	*	This function checks for the existence of the vertex.
 	*/
-	vertex<V, E>& get_vertex(const K& key) const
+	vertex<V, E, P>& get_vertex(const K& key) const
+	{
+		return *vertex_index.at(key);
+	}
+	/** \brief Look for the vertex at the given input.
+	*	\param key is the key corresponding to desired vertex.
+	*	\return the vertex at the given input, or nullptr if there is
+	*			no such vertex.
+	*/
+	vertex<V, E, P>* find_vertex(const K& key) const
 	{
-		return *vertices.at(key);
+		auto vertex_it = vertex_index.find(key);
+
+		return vertex_it != vertex_index.end() ? vertex_it->second : nullptr;
 	}
 	/** \brief Retrieve the edge connecting the vertices at the given input.
 	*	\param key_1 is the key corresponding to the first vertex.
 	*	\param key_2 is the key corresponding to the second vertex.
 	*	\return the edge connecting the vertices at the given input.
 	*
-	*	This function asserts that the keys are not equal
-	*	and that the edge exists, and checks that vertices
-	*	do indeed exist at the input keys.
+	*	This function asserts that the keys are not equal (unless
+	*	the policy allows self loops) and that the edge exists, and
+	*	checks that vertices do indeed exist at the input keys. In a
+	*	directed graph the edge must lead from the first vertex to
+	*	the second.
 	*/
-	edge<V, E>& get_edge(const K& key_1, const K& key_2) const
+	edge<V, E, P>& get_edge(const K& key_1, const K& key_2) const
 	{
-		assert(key_1 != key_2);
-
-		vertex<V, E>* vertex_1 = vertices.at(key_1);
-		vertex<V, E>* vertex_2 = vertices.at(key_2);
-
-		auto edge_it = vertex_1->edges.begin();
+		assert(P::self_loops || key_1 != key_2);
 
-		while (edge_it != vertex_1->edges.end()
-			&& (*edge_it)->vertices.at(0) != vertex_2
-			&& (*edge_it)->vertices.at(1) != vertex_2)
-		{
-			++edge_it;
-		}
+		return get_edge(*vertex_index.at(key_1), *vertex_index.at(key_2));
+	}
+	/** \brief Retrieve the edge connecting two vertices of the graph.
+	*	\param vertex_1 is the first vertex.
+	*	\param vertex_2 is the second vertex.
+	*	\return the edge connecting the vertices.
+	*
+	*	This function asserts that the edge exists. In a directed graph
+	*	the edge must lead from the first vertex to the second.
+	*/
+	edge<V, E, P>& get_edge(vertex<V, E, P>& vertex_1, vertex<V, E, P>& vertex_2) const
+	{
+		auto& edges = get_edges(vertex_1, directedness());
+		auto edge_it = find_edge(edges, &vertex_1, &vertex_2);
 
-		assert(edge_it != vertex_1->edges.end());
+		assert(edge_it != edges.end());
 
-		return *(*edge_it);
+		return *get_edge_of(*edge_it);
 	}
 	/** \brief Retrieve the key of the input vertex.
 	*	\param vertex is the vertex of the desired key.
@@ -321,17 +874,17 @@ public:
 	*
 	*	This function asserts that the vertex exists in the graph.
 	*/
-	K get_key(const vertex<V, E>& vertex) const
+	K get_key(const vertex<V, E, P>& vertex) const
 	{
-		auto vertex_it = vertices.begin();
+		auto vertex_it = vertex_index.begin();
 
-		while (vertex_it != vertices.end()
+		while (vertex_it != vertex_index.end()
 			&& vertex_it->second != &vertex)
 		{
 			++vertex_it;
 		}
 
-		assert(vertex_it != vertices.end());
+		assert(vertex_it != vertex_index.end());
 
 		return vertex_it->first;
 	}
@@ -342,96 +895,1012 @@ public:
 	{
 		return vertex_count;
 	}
-
-	/** \brief Remove the vertex at the given input.
-	*	\param key is the key corresponding to the desired vertex.
+	/** \brief Retrieve the number of edges in the graph.
+	*	\return the number of edges in the graph.
 	*
-	*	This function checks for the existence of the vertex. The
-	*	edges of the vertex are also removed. Memory is deleted.
+	*	The count is kept up to date by every change, so this takes
+	*	constant time.
 	*/
-	void remove_vertex(const K& key)
+	size_t get_edge_count() const
+	{
+		return edge_count;
+	}
+	/** \brief Compute statistics on the degrees of the vertices.
+	*	\param incoming is whether to count the incoming edges of a
+	*		   directed graph rather than the outgoing ones.
+	*	\param thread_count is the number of threads to use; 0 selects
+	*		   default_thread_count().
+	*	\return the degree statistics of the graph.
+	*
+	*	The degree of a vertex of an undirected graph is the size of its
+	*	edges, so a self loop counts twice. The vertices are visited in a
+	*	single parallel pass, each thread keeping its own histogram.
+	*/
+	graph_degree_statistics get_degree_statistics(bool incoming = false, size_t thread_count = 0) const
 	{
-		vertex<V, E>* old_vertex = vertices.at(key);
-		vertex<V, E>* connected_vertex;
+		graph_degree_statistics statistics = graph_degree_statistics();
+		statistics.vertex_count = vertex_count;
 
-		edge<V, E>* old_edge;
+		if (vertex_count == 0)
+			return statistics;
 
-		// Delete all of the desired vertex's edges.
-		while (old_vertex->edges.size() > 0)
+		std::vector<vertex<V, E, P>*> all_vertices;
+		all_vertices.reserve(vertex_count);
+
+		for (auto& key_vertex : vertex_index)
+			all_vertices.push_back(key_vertex.second);
+
+		if (thread_count == 0)
+			thread_count = default_thread_count();
+
+		std::vector<std::vector<size_t> > histograms(thread_count);
+
+		parallel_for(0, all_vertices.size(), [&](size_t first, size_t last, size_t thread_index)
 		{
-			// Take the last edge so as to use pop_back later.
-			old_edge = *(--old_vertex->edges.end());
+			std::vector<size_t>& histogram = histograms[thread_index];
 
-			if (old_vertex == old_edge->vertices.at(0))
-				connected_vertex = old_edge->vertices.at(1);
-			else
-				connected_vertex = old_edge->vertices.at(0);
+			for (size_t i = first; i < last; ++i)
+			{
+				size_t degree = incoming
+					? get_edges_in(*all_vertices[i], directedness()).size()
+					: get_edges(*all_vertices[i], directedness()).size();
 
-			old_vertex->edges.pop_back();
+				if (degree >= histogram.size())
+					histogram.resize(degree + 1, 0);
 
-			// Find the edge among the connected vertex's edges,
-			// move it to the back of the vector and pop it off.
-			auto old_edge_it = std::find(connected_vertex->edges.begin(), connected_vertex->edges.end(), old_edge);
-			*old_edge_it = *(--connected_vertex->edges.end());
-			connected_vertex->edges.pop_back();
+				++histogram[degree];
+			}
+		}, thread_count);
+
+		for (auto& histogram : histograms)
+		{
+			if (histogram.size() > statistics.histogram.size())
+				statistics.histogram.resize(histogram.size(), 0);
 
-			delete old_edge;
+			for (size_t degree = 0; degree < histogram.size(); ++degree)
+				statistics.histogram[degree] += histogram[degree];
 		}
 
-		delete old_vertex;
-		vertices.erase(key);
-		--vertex_count;
+		statistics.max_degree = statistics.histogram.size() - 1;
+		statistics.min_degree = 0;
+		while (statistics.histogram[statistics.min_degree] == 0)
+			++statistics.min_degree;
+
+		size_t degree_sum = 0;
+		for (size_t degree = 0; degree < statistics.histogram.size(); ++degree)
+			degree_sum += degree * statistics.histogram[degree];
+
+		statistics.mean_degree = double(degree_sum) / vertex_count;
+
+		return statistics;
+	}
+	/** \brief Measure the memory used by the graph.
+	*	\return the bytes used by each part of the graph.
+	*
+	*	Every vertex and edge list is visited once, so this takes time
+	*	proportional to the size of the graph.
+	*/
+	graph_memory_usage memory_usage() const
+	{
+		graph_memory_usage usage = graph_memory_usage();
+		usage.vertex_count = vertex_count;
+		usage.edge_count = edge_count;
+
+		usage.index = index_memory(vertex_index);
+		usage.vertices = vertex_index.size() * sizeof(vertex<V, E, P>);
+
+		size_t loop_payload = 0;
+
+		for (auto& key_vertex : vertex_index)
+		{
+			usage.index += payload_memory<K>::get(key_vertex.first);
+			usage.vertex_payload += payload_memory<V>::get(key_vertex.second->data);
+
+			measure_edges(*key_vertex.second, usage, loop_payload, directedness());
+		}
+
+		// Self loops were met twice, once per entry.
+		usage.edge_payload += loop_payload / 2;
+
+		usage.edges = usage.edge_count * sizeof(edge<V, E, P>);
+
+		return usage;
+	}
+	/** \brief Retrieve the neighbours of the vertex at the given input.
+	*	\param key is the key corresponding to the vertex.
+	*	\return a range of pairs of each neighbour and the edge to it.
+	*
+	*	This function checks for the existence of the vertex. In a
+	*	directed graph the neighbours are the targets of the outgoing
+	*	edges. A self loop makes a vertex its own neighbour, twice if
+	*	the graph is undirected. The range is invalidated by adding or
+	*	removing edges of the vertex.
+	*/
+	iterator_range<neighbor_iterator> neighbors(const K& key) const
+	{
+		return neighbors(*vertex_index.at(key));
+	}
+	/** \brief Retrieve the neighbours of a vertex.
+	*	\param some_vertex is a vertex of this graph.
+	*	\return a range of pairs of each neighbour and the edge to it.
+	*/
+	iterator_range<neighbor_iterator> neighbors(vertex<V, E, P>& some_vertex) const
+	{
+		auto& edges = get_edges(some_vertex, directedness());
+
+		return iterator_range<neighbor_iterator>(neighbor_iterator(edges.begin(), &some_vertex), neighbor_iterator(edges.end(), &some_vertex));
+	}
+	/** \brief Retrieve the number of neighbours of a vertex.
+	*	\param some_vertex is a vertex of this graph.
+	*	\return the number of entries neighbors(some_vertex) yields.
+	*/
+	size_t get_degree(vertex<V, E, P>& some_vertex) const
+	{
+		return get_edges(some_vertex, directedness()).size();
+	}
+	/** \brief Retrieve the vertices with edges into the vertex at the
+	*		   given input.
+	*	\param key is the key corresponding to the vertex.
+	*	\return a range of pairs of each neighbour and the edge from it.
+	*
+	*	This function checks for the existence of the vertex. In an
+	*	undirected graph it is the same as neighbors.
+	*/
+	iterator_range<neighbor_iterator> in_neighbors(const K& key) const
+	{
+		return in_neighbors(*vertex_index.at(key));
+	}
+	/** \brief Retrieve the vertices with edges into a vertex.
+	*	\param some_vertex is a vertex of this graph.
+	*	\return a range of pairs of each neighbour and the edge from it.
+	*/
+	iterator_range<neighbor_iterator> in_neighbors(vertex<V, E, P>& some_vertex) const
+	{
+		auto& edges = get_edges_in(some_vertex, directedness());
+
+		return iterator_range<neighbor_iterator>(neighbor_iterator(edges.begin(), &some_vertex), neighbor_iterator(edges.end(), &some_vertex));
+	}
+	/** \brief Retrieve the vertices of the graph.
+	*	\return a range of the vertices, in the order of begin() to end().
+	*/
+	iterator_range<vertex_iterator> vertices() const
+	{
+		return iterator_range<vertex_iterator>(vertex_iterator(vertex_index.begin()), vertex_iterator(vertex_index.end()));
+	}
+	/** \brief Retrieve the edges of the graph.
+	*	\return a range visiting each edge exactly once.
+	*
+	*	The edges are grouped by their vertices[0], in the order of
+	*	begin() to end(); finding the next edge may skip the entries of
+	*	edges listed elsewhere, so a full pass takes O(V + E) time.
+	*/
+	iterator_range<edge_iterator> edges() const
+	{
+		return iterator_range<edge_iterator>(edge_iterator(vertex_index.begin(), vertex_index.end()), edge_iterator(vertex_index.end(), vertex_index.end()));
+	}
+	/** \brief Call a function on every edge of the graph, in parallel.
+	*	\param function is called as function(edge, thread_index) once
+	*		   for each edge.
+	*	\param thread_count is the number of threads to use; 0 selects
+	*		   default_thread_count().
+	*
+	*	The vertices are split into ranges which threads take in turn,
+	*	and each edge is visited from its vertices[0] as in edges(), so
+	*	no thread ever sees another's edges and no record of the edges
+	*	already seen is kept. thread_index is in [0, thread_count) and
+	*	may be used to select thread-local accumulators. The graph must
+	*	not be modified meanwhile, though edge data may be.
+	*/
+	template <typename F>
+	void for_each_edge(F function, size_t thread_count = 0) const
+	{
+		std::vector<vertex<V, E, P>*> owners;
+		owners.reserve(vertex_count);
+
+		for (auto& key_vertex : vertex_index)
+			owners.push_back(key_vertex.second);
+
+		parallel_for(0, owners.size(), [&](size_t first, size_t last, size_t thread_index)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				auto& edges = get_edges(*owners[i], directedness());
+
+				for (auto entry_it = edges.begin(); entry_it != edges.end(); ++entry_it)
+				{
+					if (is_listing_entry(edges, entry_it, owners[i], directedness()))
+						function(*get_edge_of(*entry_it), thread_index);
+				}
+			}
+		}, thread_count, 256);
+	}
+	/** \brief Retrieve an iterator to the first vertex of the graph.
+	*	\return an iterator to the first vertex of the graph.
+	*
+	*	The order of iteration is unspecified, but it is stable for
+	*	as long as the graph is not modified.
+	*/
+	const_iterator begin() const
+	{
+		return vertex_index.begin();
+	}
+	/** \brief Retrieve an iterator past the last vertex of the graph.
+	*	\return an iterator past the last vertex of the graph.
+	*/
+	const_iterator end() const
+	{
+		return vertex_index.end();
+	}
+
+	/** \brief Remove the vertex at the given input.
+	*	\param key is the key corresponding to the desired vertex.
+	*
+	*	This function checks for the existence of the vertex. The
+	*	edges of the vertex are also removed. Memory is deleted.
+	*/
+	void remove_vertex(const K& key)
+	{
+		vertex<V, E, P>* old_vertex = vertex_index.at(key);
+
+		unlink_all(old_vertex, directedness());
+
+		destroy(old_vertex);
+		vertex_index.erase(key);
+		--vertex_count;
 	}
 	/** \brief Remove the edge conntecting the vertices at the given input.
 	*	\param key_1 is the key corresponding to the origin vertex.
 	*	\param key_2 is the key corresponding to the destination vertex.
 	*
-	*	This function asserts that the keys are not equal
-	*	and that the edge exists, and checks that vertices
-	*	do indeed exist at the input keys. Memory is deleted.
+	*	This function asserts that the keys are not equal (unless
+	*	the policy allows self loops) and that the edge exists, and
+	*	checks that vertices do indeed exist at the input keys.
+	*	Memory is deleted.
 	*/
 	void remove_edge(const K& key_1, const K& key_2)
 	{
-		assert(key_1 != key_2);
+		assert(P::self_loops || key_1 != key_2);
 
-		vertex<V, E>* vertex_1 = vertices.at(key_1);
-		vertex<V, E>* vertex_2 = vertices.at(key_2);
+		remove_edge(*vertex_index.at(key_1), *vertex_index.at(key_2));
+	}
+	/** \brief Remove the edge connecting two vertices of the graph.
+	*	\param vertex_1 is the origin vertex.
+	*	\param vertex_2 is the destination vertex.
+	*
+	*	This function asserts that the edge exists. Memory is deleted.
+	*/
+	void remove_edge(vertex<V, E, P>& vertex_1, vertex<V, E, P>& vertex_2)
+	{
+		// Find the desired edge among the first vertex's edges.
+		auto& edges = get_edges(vertex_1, directedness());
+		auto edge_it = find_edge(edges, &vertex_1, &vertex_2);
 
-		auto edge_it = vertex_1->edges.begin();
+		assert(edge_it != edges.end());
 
-		// Find the desired edge among the first vertex's edges.
-		while (edge_it != vertex_1->edges.end()
-			&& (*edge_it)->vertices.at(0) != vertex_2
-			&& (*edge_it)->vertices.at(1) != vertex_2)
-		{
+		// Point to the desired edge for later deletion.
+		edge<V, E, P>* old_edge = get_edge_of(*edge_it);
+
+		// Move the desired edge to the back of the vector and pop it off.
+		*edge_it = edges.back();
+		edges.pop_back();
+
+		// Do the same among the second vertex's edges.
+		detach(get_edges_in(vertex_2, directedness()), old_edge);
+
+		destroy(old_edge);
+		--edge_count;
+	}
+
+#if __cplusplus >= 202002L
+	/** \brief Whether a type of key other than K can look vertices up
+	*		   without being converted to a K.
+	*
+	*	This holds when H is transparent (declares is_transparent, like
+	*	string_key_hash) and the index can find by the type, as the
+	*	default hashed_index can. The overloads below then take keys of
+	*	such a type, e.g. a std::string_view or a string literal into a
+	*	graph keyed by std::string, so looking vertices up allocates no
+	*	temporary key. They check for the vertices as at() does.
+	*/
+	template <typename Q>
+	static constexpr bool is_lookup_key = !std::is_same<typename std::decay<Q>::type, K>::value && requires (const index_type& index, const Q& key)
+	{
+		typename H::is_transparent;
+		index.find(key);
+	};
+
+	template <typename Q> requires is_lookup_key<Q>
+	vertex<V, E, P>& get_vertex(const Q& key) const
+	{
+		return *lookup(key);
+	}
+	template <typename Q> requires is_lookup_key<Q>
+	vertex<V, E, P>* find_vertex(const Q& key) const
+	{
+		auto vertex_it = vertex_index.find(key);
+
+		return vertex_it != vertex_index.end() ? vertex_it->second : nullptr;
+	}
+	template <typename Q, typename R> requires is_lookup_key<Q> && is_lookup_key<R>
+	edge<V, E, P>& add_edge(const Q& key_1, const R& key_2, const E& edge_data)
+	{
+		return add_edge(*lookup(key_1), *lookup(key_2), edge_data);
+	}
+	template <typename Q, typename R> requires is_lookup_key<Q> && is_lookup_key<R>
+	edge<V, E, P>& get_edge(const Q& key_1, const R& key_2) const
+	{
+		return get_edge(*lookup(key_1), *lookup(key_2));
+	}
+	template <typename Q, typename R> requires is_lookup_key<Q> && is_lookup_key<R>
+	void remove_edge(const Q& key_1, const R& key_2)
+	{
+		remove_edge(*lookup(key_1), *lookup(key_2));
+	}
+	template <typename Q> requires is_lookup_key<Q>
+	iterator_range<neighbor_iterator> neighbors(const Q& key) const
+	{
+		return neighbors(*lookup(key));
+	}
+	template <typename Q> requires is_lookup_key<Q>
+	iterator_range<neighbor_iterator> in_neighbors(const Q& key) const
+	{
+		return in_neighbors(*lookup(key));
+	}
+#endif
+
+	/** \brief Reclaims memory left unused by removals.
+	*	\param relocate is whether to move the vertices and edges into
+	*		   fresh contiguous storage in breadth-first order.
+	*
+	*	Every edge list is shrunk to its size and the vertex index is
+	*	rebuilt for the current number of vertices, which also gathers
+	*	its nodes together. With relocate, the vertices and then the
+	*	edges are moved into one block each, laid out in the order of a
+	*	breadth-first search, so that neighbours tend to share cache
+	*	lines and pages; each edge is placed with its vertices[0].\n
+	*	Relocation invalidates every reference to a vertex or an edge.
+	*	Memory is allocated and deleted.
+	*/
+	void compact(bool relocate = false)
+	{
+		if (relocate)
+			relocate_vertices(get_breadth_first_order());
+
+		for (auto& key_vertex : vertex_index)
+			shrink_edges(*key_vertex.second, directedness());
+
+		index_type fresh;
+		fresh.reserve(vertex_count);
+		fresh.insert(vertex_index.begin(), vertex_index.end());
+		vertex_index.swap(fresh);
+	}
+	/** \brief Reclaims memory left unused by removals and relocates the
+	*		   vertices and edges in a given order.
+	*	\param order is every vertex of the graph, each once, in the
+	*		   order in which to lay them out.
+	*
+	*	This is compact(true) with the layout chosen by the caller, for
+	*	instance by one of the orderings of Reordering.h.
+	*/
+	void compact(const std::vector<vertex<V, E, P>*>& order)
+	{
+		relocate_vertices(order);
+		compact(false);
+	}
+
+private:
+	/** \brief Selects the overloads for directed or undirected graphs.
+	*/
+	typedef std::integral_constant<bool, P::directed> directedness;
+	/** \brief Selects the overloads for inline adjacency entries.
+	*/
+	typedef std::integral_constant<bool, P::inline_neighbors> inlining;
+	/** \brief The container of a vertex's edges.
+	*/
+	typedef typename vertex<V, E, P>::edge_list edge_list;
+
+#if __cplusplus >= 202002L
+	/** \brief Retrieve the vertex of a key of another type.
+	*
+	*	This function throws std::out_of_range if there is no vertex.
+	*/
+	template <typename Q>
+	vertex<V, E, P>* lookup(const Q& key) const
+	{
+		auto vertex_it = vertex_index.find(key);
+
+		if (vertex_it == vertex_index.end())
+			throw std::out_of_range("dynamic_sparse_graph::lookup: no vertex at key");
+
+		return vertex_it->second;
+	}
+#endif
+
+	/** \brief Retrieve the edge of an adjacency entry.
+	*/
+	static edge<V, E, P>* get_edge_of(edge<V, E, P>* entry)
+	{
+		return entry;
+	}
+	/** \brief Retrieve the edge of an inline adjacency entry.
+	*/
+	static edge<V, E, P>* get_edge_of(const adjacency_entry<V, E, P>& entry)
+	{
+		return entry.connecting_edge;
+	}
+	/** \brief Retrieve the far end of an adjacency entry of a vertex.
+	*
+	*	The far end is vertices[1] exactly when the vertex is vertices[0],
+	*	which also holds for a self loop.
+	*/
+	static vertex<V, E, P>* get_neighbor_of(edge<V, E, P>* entry, vertex<V, E, P>* some_vertex)
+	{
+		return entry->vertices[entry->vertices[0] == some_vertex];
+	}
+	/** \brief Retrieve the far end of an inline adjacency entry.
+	*/
+	static vertex<V, E, P>* get_neighbor_of(const adjacency_entry<V, E, P>& entry, vertex<V, E, P>*)
+	{
+		return entry.neighbor;
+	}
+	/** \brief Make the adjacency entry of an edge for one of its vertices.
+	*/
+	static edge<V, E, P>* make_entry(edge<V, E, P>* new_edge, vertex<V, E, P>*, std::false_type)
+	{
+		return new_edge;
+	}
+	/** \brief Make the inline adjacency entry of an edge for one of its
+	*		   vertices.
+	*/
+	static adjacency_entry<V, E, P> make_entry(edge<V, E, P>* new_edge, vertex<V, E, P>* neighbor, std::true_type)
+	{
+		adjacency_entry<V, E, P> entry = { neighbor, new_edge };
+		return entry;
+	}
+	/** \brief The edges of a vertex of an undirected graph.
+	*/
+	static edge_list& get_edges(vertex<V, E, P>& some_vertex, std::false_type)
+	{
+		return some_vertex.edges;
+	}
+	/** \brief The outgoing edges of a vertex of a directed graph.
+	*/
+	static edge_list& get_edges(vertex<V, E, P>& some_vertex, std::true_type)
+	{
+		return some_vertex.out_edges;
+	}
+	/** \brief The edges of a vertex of an undirected graph.
+	*/
+	static edge_list& get_edges_in(vertex<V, E, P>& some_vertex, std::false_type)
+	{
+		return some_vertex.edges;
+	}
+	/** \brief The incoming edges of a vertex of a directed graph.
+	*/
+	static edge_list& get_edges_in(vertex<V, E, P>& some_vertex, std::true_type)
+	{
+		return some_vertex.in_edges;
+	}
+	/** \brief Find the edge to a vertex among a vertex's edges, or its
+	*		   outgoing edges if the graph is directed.
+	*/
+	static typename edge_list::iterator find_edge(edge_list& edges, vertex<V, E, P>* some_vertex, vertex<V, E, P>* other_vertex)
+	{
+		auto edge_it = edges.begin();
+
+		while (edge_it != edges.end() && get_neighbor_of(*edge_it, some_vertex) != other_vertex)
 			++edge_it;
+
+		return edge_it;
+	}
+	/** \brief Parallel edges are allowed; there is nothing to look for.
+	*/
+	static edge<V, E, P>* find_parallel(vertex<V, E, P>&, vertex<V, E, P>&, std::true_type)
+	{
+		return nullptr;
+	}
+	/** \brief Look for an edge which already connects two vertices.
+	*/
+	static edge<V, E, P>* find_parallel(vertex<V, E, P>& vertex_1, vertex<V, E, P>& vertex_2, std::false_type)
+	{
+		auto& edges = get_edges(vertex_1, directedness());
+		auto edge_it = find_edge(edges, &vertex_1, &vertex_2);
+
+		return edge_it != edges.end() ? get_edge_of(*edge_it) : nullptr;
+	}
+	/** \brief One end of an edge added by add_edges.
+	*/
+	struct edge_end
+	{
+		/** \brief The id of the vertex whose list takes the entry.
+		*/
+		size_t vertex_id;
+		/** \brief The index of the edge in ends.
+		*/
+		size_t edge_index;
+	};
+
+	/** \brief Add edges to a simple graph one by one.
+	*/
+	void add_edges(const std::vector<vertex<V, E, P>*>& id_vertices, const std::vector<std::array<size_t, 2> >& ends, const std::vector<E>& edge_data, size_t, std::false_type)
+	{
+		for (size_t i = 0; i < ends.size(); ++i)
+			add_edge(*id_vertices[ends[i][0]], *id_vertices[ends[i][1]], edge_data[i]);
+	}
+	/** \brief Add edges to a multigraph in parallel.
+	*/
+	void add_edges(const std::vector<vertex<V, E, P>*>& id_vertices, const std::vector<std::array<size_t, 2> >& ends, const std::vector<E>& edge_data, size_t thread_count, std::true_type)
+	{
+		if (ends.empty())
+			return;
+
+		edge<V, E, P>* edge_block = allocate_pool<edge<V, E, P> >(ends.size());
+
+		parallel_for(0, ends.size(), [&](size_t first, size_t last, size_t)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				assert(P::self_loops || ends[i][0] != ends[i][1]);
+
+				std::array<vertex<V, E, P>*, 2> new_edge_vertices = { id_vertices[ends[i][0]], id_vertices[ends[i][1]] };
+				::new (static_cast<void*>(edge_block + i)) edge<V, E, P>(new_edge_vertices, edge_data[i]);
+			}
+		}, thread_count);
+
+		if (P::directed)
+		{
+			fill_edges(id_vertices, ends, edge_block, 0, 1, thread_count, [](vertex<V, E, P>& some_vertex) -> edge_list& { return get_edges(some_vertex, directedness()); });
+			fill_edges(id_vertices, ends, edge_block, 1, 1, thread_count, [](vertex<V, E, P>& some_vertex) -> edge_list& { return get_edges_in(some_vertex, directedness()); });
+		}
+		else
+		{
+			fill_edges(id_vertices, ends, edge_block, 0, 2, thread_count, [](vertex<V, E, P>& some_vertex) -> edge_list& { return get_edges(some_vertex, directedness()); });
 		}
 
-		assert(edge_it != vertex_1->edges.end());
+		edge_count += ends.size();
+	}
+	/** \brief Append the new edges of add_edges to the lists of their
+	*		   vertices.
+	*	\param first_end is the first end of each edge to list.
+	*	\param end_count is the number of ends of each edge to list.
+	*	\param get_list retrieves the list of a vertex which takes them.
+	*/
+	template <typename F>
+	static void fill_edges(const std::vector<vertex<V, E, P>*>& id_vertices, const std::vector<std::array<size_t, 2> >& ends, edge<V, E, P>* edge_block, size_t first_end, size_t end_count, size_t thread_count, F get_list)
+	{
+		std::vector<edge_end> sorted_ends(ends.size() * end_count);
 
-		// Point to the desired edge for later deletion.
-		edge<V, E>* old_edge = *edge_it;
+		parallel_for(0, ends.size(), [&](size_t first, size_t last, size_t)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				for (size_t end = 0; end < end_count; ++end)
+				{
+					edge_end new_end = { ends[i][first_end + end], i };
+					sorted_ends[i * end_count + end] = new_end;
+				}
+			}
+		}, thread_count);
 
-		// Move the desired edge to the back of the vector and pop it off.
-		*edge_it = *(--vertex_1->edges.end());
-		vertex_1->edges.pop_back();
+		parallel_radix_sort(sorted_ends, [](const edge_end& some_end)
+		{
+			return some_end.vertex_id;
+		}, id_vertices.size() - 1, thread_count);
+
+		// The ends of each vertex now form a run; find where each lies.
+		std::vector<size_t> run_firsts(id_vertices.size(), 0);
+		std::vector<size_t> run_lasts(id_vertices.size(), 0);
+
+		parallel_for(0, sorted_ends.size(), [&](size_t first, size_t last, size_t)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				if (i == 0 || sorted_ends[i].vertex_id != sorted_ends[i - 1].vertex_id)
+					run_firsts[sorted_ends[i].vertex_id] = i;
+				if (i + 1 == sorted_ends.size() || sorted_ends[i].vertex_id != sorted_ends[i + 1].vertex_id)
+					run_lasts[sorted_ends[i].vertex_id] = i + 1;
+			}
+		}, thread_count);
+
+		parallel_for(0, id_vertices.size(), [&](size_t first, size_t last, size_t)
+		{
+			for (size_t id = first; id < last; ++id)
+			{
+				if (run_lasts[id] == 0)
+					continue;
+
+				vertex<V, E, P>* some_vertex = id_vertices[id];
+				edge_list& edges = get_list(*some_vertex);
+				edges.reserve(edges.size() + run_lasts[id] - run_firsts[id]);
 
-		// Find the desired edge among the second vertex's edges,
-		// move it to the back of the vector and pop it off.
-		auto old_edge_it = std::find(vertex_2->edges.begin(), vertex_2->edges.end(), old_edge);
-		*old_edge_it = *(--vertex_2->edges.end());
-		vertex_2->edges.pop_back();
+				for (size_t i = run_firsts[id]; i < run_lasts[id]; ++i)
+				{
+					edge<V, E, P>* new_edge = edge_block + sorted_ends[i].edge_index;
+					edges.push_back(make_entry(new_edge, get_neighbor_of(new_edge, some_vertex), inlining()));
+				}
+			}
+		}, thread_count);
+	}
+	/** \brief Checks whether an entry of an undirected graph is where
+	*		   its edge is listed by edges().
+	*
+	*	An edge is listed at its vertices[0]; a self loop, which has two
+	*	entries there, at the first of them.
+	*/
+	static bool is_listing_entry(edge_list& edges, typename edge_list::iterator entry_it, vertex<V, E, P>* some_vertex, std::false_type)
+	{
+		edge<V, E, P>* some_edge = get_edge_of(*entry_it);
+
+		if (some_edge->vertices[0] != some_vertex)
+			return false;
+		if (!P::self_loops || some_edge->vertices[1] != some_vertex)
+			return true;
+
+		for (auto other_it = edges.begin(); other_it != entry_it; ++other_it)
+		{
+			if (get_edge_of(*other_it) == some_edge)
+				return false;
+		}
+
+		return true;
+	}
+	/** \brief Every outgoing entry of a directed graph lists its edge.
+	*/
+	static bool is_listing_entry(edge_list&, typename edge_list::iterator, vertex<V, E, P>*, std::true_type)
+	{
+		return true;
+	}
+	/** \brief Move an edge to the back of a vertex's edges and pop it off.
+	*/
+	static void detach(edge_list& edges, edge<V, E, P>* old_edge)
+	{
+		auto old_edge_it = edges.begin();
+		while (get_edge_of(*old_edge_it) != old_edge)
+			++old_edge_it;
 
-		delete old_edge;
+		*old_edge_it = edges.back();
+		edges.pop_back();
 	}
+	/** \brief Add a new edge to the edges of both its vertices.
+	*/
+	static void link(edge<V, E, P>* new_edge, std::false_type)
+	{
+		new_edge->vertices[0]->edges.push_back(make_entry(new_edge, new_edge->vertices[1], inlining()));
+		new_edge->vertices[1]->edges.push_back(make_entry(new_edge, new_edge->vertices[0], inlining()));
+	}
+	/** \brief Add a new edge to the outgoing edges of its source and
+	*		   the incoming edges of its target.
+	*/
+	static void link(edge<V, E, P>* new_edge, std::true_type)
+	{
+		new_edge->vertices[0]->out_edges.push_back(make_entry(new_edge, new_edge->vertices[1], inlining()));
+		new_edge->vertices[1]->in_edges.push_back(make_entry(new_edge, new_edge->vertices[0], inlining()));
+	}
+	/** \brief Delete every edge of a vertex of an undirected graph.
+	*/
+	void unlink_all(vertex<V, E, P>* old_vertex, std::false_type)
+	{
+		vertex<V, E, P>* connected_vertex;
+
+		edge<V, E, P>* old_edge;
+
+		// Delete all of the desired vertex's edges.
+		while (old_vertex->edges.size() > 0)
+		{
+			// Take the last edge so as to use pop_back later.
+			old_edge = get_edge_of(old_vertex->edges.back());
+			connected_vertex = get_neighbor_of(old_vertex->edges.back(), old_vertex);
+
+			old_vertex->edges.pop_back();
+
+			// Find the edge among the connected vertex's edges,
+			// move it to the back of the vector and pop it off.
+			detach(connected_vertex->edges, old_edge);
+
+			destroy(old_edge);
+			--edge_count;
+		}
+	}
+	/** \brief Delete every edge of a vertex of a directed graph.
+	*/
+	void unlink_all(vertex<V, E, P>* old_vertex, std::true_type)
+	{
+		edge<V, E, P>* old_edge;
+
+		while (old_vertex->out_edges.size() > 0)
+		{
+			old_edge = get_edge_of(old_vertex->out_edges.back());
+			old_vertex->out_edges.pop_back();
+
+			detach(old_edge->vertices[1]->in_edges, old_edge);
+
+			destroy(old_edge);
+			--edge_count;
+		}
+
+		while (old_vertex->in_edges.size() > 0)
+		{
+			old_edge = get_edge_of(old_vertex->in_edges.back());
+			old_vertex->in_edges.pop_back();
+
+			detach(old_edge->vertices[0]->out_edges, old_edge);
+
+			destroy(old_edge);
+			--edge_count;
+		}
+	}
+	/** \brief Measure the heap buffer of a std::vector edge list.
+	*/
+	template <typename T>
+	static void measure_list(const std::vector<T>& edges, graph_memory_usage& usage)
+	{
+		usage.adjacency += edges.capacity() * sizeof(T);
+		usage.adjacency_slack += (edges.capacity() - edges.size()) * sizeof(T);
+	}
+	/** \brief Measure the heap buffer of a small_vector edge list, if it
+	*		   has left its inline buffer.
+	*/
+	template <typename T, size_t C>
+	static void measure_list(const small_vector<T, C>& edges, graph_memory_usage& usage)
+	{
+		if (edges.is_inline())
+			return;
+
+		usage.adjacency += edges.capacity() * sizeof(T);
+		usage.adjacency_slack += (edges.capacity() - edges.size()) * sizeof(T);
+	}
+	/** \brief Measure the edge list of a vertex of an undirected graph
+	*		   and the data of the edges whose vertices[0] it is.
+	*
+	*	The data of self loops is counted twice, since they have both
+	*	entries at this vertex.
+	*/
+	static void measure_edges(const vertex<V, E, P>& some_vertex, graph_memory_usage& usage, size_t& loop_payload, std::false_type)
+	{
+		measure_list(some_vertex.edges, usage);
 
+		for (auto& entry : some_vertex.edges)
+		{
+			const edge<V, E, P>* some_edge = get_edge_of(entry);
+			if (some_edge->vertices[0] != &some_vertex)
+				continue;
+
+			if (some_edge->vertices[1] == &some_vertex)
+				loop_payload += payload_memory<E>::get(some_edge->data);
+			else
+				usage.edge_payload += payload_memory<E>::get(some_edge->data);
+		}
+	}
+	/** \brief Measure the edge lists of a vertex of a directed graph and
+	*		   its outgoing edges.
+	*/
+	static void measure_edges(const vertex<V, E, P>& some_vertex, graph_memory_usage& usage, size_t&, std::true_type)
+	{
+		measure_list(some_vertex.out_edges, usage);
+		measure_list(some_vertex.in_edges, usage);
+
+		for (auto& entry : some_vertex.out_edges)
+			usage.edge_payload += payload_memory<E>::get(get_edge_of(entry)->data);
+	}
+	/** \brief A block holding relocated vertices or edges.
+	*/
+	struct pool
+	{
+		/** \brief The first byte of the block.
+		*/
+		char* first;
+		/** \brief The byte past the end of the block.
+		*/
+		char* last;
+		/** \brief The number of objects still alive in the block.
+		*/
+		size_t live;
+	};
+
+	/** \brief Delete a vertex or an edge, wherever it was allocated.
+	*
+	*	Objects outside the pools came from new. A pooled object is only
+	*	destroyed, and its block is freed with its last object.
+	*/
+	template <typename T>
+	void destroy(T* old_object)
+	{
+		char* address = reinterpret_cast<char*>(old_object);
+
+		auto pool_it = std::upper_bound(pools.begin(), pools.end(), address, [](char* some_address, const pool& some_pool)
+		{
+			return some_address < some_pool.first;
+		});
+
+		if (pool_it == pools.begin() || address >= (--pool_it)->last)
+		{
+			delete old_object;
+			return;
+		}
+
+		old_object->~T();
+
+		if (--pool_it->live == 0)
+		{
+			::operator delete(pool_it->first);
+			pools.erase(pool_it);
+		}
+	}
+	/** \brief Allocate a pool for a number of objects.
+	*/
+	template <typename T>
+	T* allocate_pool(size_t count)
+	{
+		char* first = static_cast<char*>(::operator new(count * sizeof(T)));
+
+		pool new_pool = { first, first + count * sizeof(T), count };
+		pools.insert(std::upper_bound(pools.begin(), pools.end(), first, [](char* some_address, const pool& some_pool)
+		{
+			return some_address < some_pool.first;
+		}), new_pool);
+
+		return reinterpret_cast<T*>(first);
+	}
+	/** \brief Call a function on every adjacency entry of a vertex of an
+	*		   undirected graph.
+	*/
+	template <typename F>
+	static void for_each_entry(vertex<V, E, P>& some_vertex, F function, std::false_type)
+	{
+		for (auto& entry : some_vertex.edges)
+			function(entry);
+	}
+	/** \brief Call a function on every adjacency entry of a vertex of a
+	*		   directed graph, outgoing and then incoming.
+	*/
+	template <typename F>
+	static void for_each_entry(vertex<V, E, P>& some_vertex, F function, std::true_type)
+	{
+		for (auto& entry : some_vertex.out_edges)
+			function(entry);
+		for (auto& entry : some_vertex.in_edges)
+			function(entry);
+	}
+	/** \brief Shrink the edge list of a vertex of an undirected graph.
+	*/
+	static void shrink_edges(vertex<V, E, P>& some_vertex, std::false_type)
+	{
+		some_vertex.edges.shrink_to_fit();
+	}
+	/** \brief Shrink the edge lists of a vertex of a directed graph.
+	*/
+	static void shrink_edges(vertex<V, E, P>& some_vertex, std::true_type)
+	{
+		some_vertex.out_edges.shrink_to_fit();
+		some_vertex.in_edges.shrink_to_fit();
+	}
+	/** \brief Retrieve the vertices in breadth-first order.
+	*
+	*	Each search starts from the first unvisited vertex of the index
+	*	and follows edges in both directions.
+	*/
+	std::vector<vertex<V, E, P>*> get_breadth_first_order() const
+	{
+		std::vector<vertex<V, E, P>*> order;
+		order.reserve(vertex_count);
+
+		std::unordered_set<const vertex<V, E, P>*> visited;
+		visited.reserve(vertex_count);
+
+		for (auto& key_vertex : vertex_index)
+		{
+			if (!visited.insert(key_vertex.second).second)
+				continue;
+
+			// order doubles as the queue of the search.
+			size_t head = order.size();
+			order.push_back(key_vertex.second);
+
+			while (head < order.size())
+			{
+				vertex<V, E, P>* current = order[head++];
+
+				for_each_entry(*current, [&](const typename edge_list::value_type& entry)
+				{
+					vertex<V, E, P>* neighbor = get_neighbor_of(entry, current);
+					if (visited.insert(neighbor).second)
+						order.push_back(neighbor);
+				}, directedness());
+			}
+		}
+
+		return order;
+	}
+	/** \brief Move every vertex and edge into two fresh pools.
+	*	\param order is every vertex of the graph, in the order in which
+	*		   to lay them out.
+	*/
+	void relocate_vertices(const std::vector<vertex<V, E, P>*>& order)
+	{
+		assert(order.size() == vertex_count);
+
+		if (vertex_count == 0)
+			return;
+
+		std::unordered_map<const vertex<V, E, P>*, vertex<V, E, P>*> new_vertices;
+		new_vertices.reserve(vertex_count);
+
+		std::unordered_map<const edge<V, E, P>*, edge<V, E, P>*> new_edges;
+		std::vector<edge<V, E, P>*> old_edges;
+
+		// Each edge is placed with its vertices[0]; self loops are met twice.
+		for (auto old_vertex : order)
+		{
+			for_each_entry(*old_vertex, [&](const typename edge_list::value_type& entry)
+			{
+				edge<V, E, P>* old_edge = get_edge_of(entry);
+				if (old_edge->vertices[0] == old_vertex && new_edges.insert(std::make_pair(old_edge, nullptr)).second)
+					old_edges.push_back(old_edge);
+			}, directedness());
+		}
+
+		vertex<V, E, P>* vertex_block = allocate_pool<vertex<V, E, P> >(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			new_vertices[order[i]] = ::new (static_cast<void*>(vertex_block + i)) vertex<V, E, P>(std::move(*order[i]));
+
+		if (!old_edges.empty())
+		{
+			edge<V, E, P>* edge_block = allocate_pool<edge<V, E, P> >(old_edges.size());
+			for (size_t i = 0; i < old_edges.size(); ++i)
+			{
+				edge<V, E, P>* old_edge = old_edges[i];
+
+				std::array<vertex<V, E, P>*, 2> new_edge_vertices = { new_vertices[old_edge->vertices[0]], new_vertices[old_edge->vertices[1]] };
+				new_edges[old_edge] = ::new (static_cast<void*>(edge_block + i)) edge<V, E, P>(new_edge_vertices, old_edge->data);
+			}
+		}
+
+		// Point the moved entries at the moved edges and neighbours.
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			vertex<V, E, P>* new_vertex = vertex_block + i;
+
+			for_each_entry(*new_vertex, [&](typename edge_list::value_type& entry)
+			{
+				retarget(entry, new_edges, new_vertices);
+			}, directedness());
+		}
+
+		for (auto& key_vertex : vertex_index)
+			key_vertex.second = new_vertices[key_vertex.second];
+
+		for (auto old_edge : old_edges)
+			destroy(old_edge);
+		for (auto old_vertex : order)
+			destroy(old_vertex);
+	}
+	/** \brief Point an adjacency entry at the relocated edge.
+	*/
+	static void retarget(edge<V, E, P>*& entry, const std::unordered_map<const edge<V, E, P>*, edge<V, E, P>*>& new_edges, const std::unordered_map<const vertex<V, E, P>*, vertex<V, E, P>*>&)
+	{
+		entry = new_edges.at(entry);
+	}
+	/** \brief Point an inline adjacency entry at the relocated edge and
+	*		   neighbour.
+	*/
+	static void retarget(adjacency_entry<V, E, P>& entry, const std::unordered_map<const edge<V, E, P>*, edge<V, E, P>*>& new_edges, const std::unordered_map<const vertex<V, E, P>*, vertex<V, E, P>*>& new_vertices)
+	{
+		entry.connecting_edge = new_edges.at(entry.connecting_edge);
+		entry.neighbor = new_vertices.at(entry.neighbor);
+	}
 private:
 	/** \brief This is the number of vertices contained by the graph.
 	*/
 	size_t vertex_count;
+	/** \brief This is the number of edges contained by the graph.
+	*/
+	size_t edge_count;
 	/** \brief This is the container of the graph's vertices.
 	*/
-	std::unordered_map<K, vertex<V, E>*, H> vertices;
+	index_type vertex_index;
+	/** \brief The blocks of relocated vertices and edges, by address.
+	*/
+	std::vector<pool> pools;
 
 };
 
@@ -0,0 +1,139 @@
+
+
+#ifndef GRAPH_BUILDER_H
+#define GRAPH_BUILDER_H
+
+#include "Graph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+/** \brief Adds an array of edges to a graph in parallel.
+*	\param graph is the graph to add to; it is usually empty.
+*	\param endpoints holds the keys of the two vertices of each edge;
+*		   in a directed graph the edge leads from the first to the
+*		   second.
+*	\param edge_data holds the data of each edge.
+*	\param vertex_data is the data given to every vertex which does
+*		   not exist yet.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*
+*	This spares the allocation of every edge and the repeated growth of
+*	the edge lists of calling add_edge for each edge, and spreads the
+*	work over threads. Each thread splits its part of the endpoints into
+*	one buffer per shard by hash, and each thread then numbers the
+*	distinct keys of one shard from the buffers of every part, so every
+*	key is hashed a fixed number of times whatever the thread count;
+*	the missing vertices are then added, and the endpoints are
+*	translated to dense ids in parallel. The edges are handed to
+*	dynamic_sparse_graph::add_edges, which radix sorts their ends by
+*	vertex, sizes every edge list once and builds the edges and lists
+*	in parallel.\n
+*	Adding the vertices to the index is the only serial step. Besides
+*	the edges themselves, this takes up to 96 bytes per edge while
+*	running.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+void add_edge_array(dynamic_sparse_graph<K, H, V, E, P>& graph, const std::vector<std::array<K, 2> >& endpoints, const std::vector<E>& edge_data, const V& vertex_data, size_t thread_count = 0)
+{
+	if (endpoints.size() != edge_data.size())
+		throw std::runtime_error("add_edge_array: endpoints and edge_data differ in size");
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+
+	auto get_shard = [&](const K& key) -> size_t
+	{
+		// Mix the hash so the shards do not share residues with the buckets.
+		return size_t((std::uint64_t(H()(key)) * 0x9e3779b97f4a7c15ULL) >> 32) % thread_count;
+	};
+
+	// Split the endpoints into equal parts, and each part into one buffer
+	// per shard. The parts are fixed, so the numbering is deterministic.
+	std::vector<std::vector<std::vector<const K*> > > part_buffers(thread_count, std::vector<std::vector<const K*> >(thread_count));
+
+	parallel_for(0, thread_count, [&](size_t part_first, size_t part_last, size_t)
+	{
+		for (size_t part = part_first; part < part_last; ++part)
+		{
+			auto& buffers = part_buffers[part];
+			size_t first = endpoints.size() * part / thread_count;
+			size_t last = endpoints.size() * (part + 1) / thread_count;
+
+			for (auto& buffer : buffers)
+				buffer.reserve(2 * (last - first) / thread_count + 1);
+
+			for (size_t i = first; i < last; ++i)
+			{
+				for (auto& key : endpoints[i])
+					buffers[get_shard(key)].push_back(&key);
+			}
+		}
+	}, thread_count, 1);
+
+	// Each thread numbers the keys of its own shard.
+	std::vector<std::unordered_map<K, size_t, H> > shard_ids(thread_count);
+
+	parallel_for(0, thread_count, [&](size_t shard_first, size_t shard_last, size_t)
+	{
+		for (size_t shard = shard_first; shard < shard_last; ++shard)
+		{
+			auto& ids = shard_ids[shard];
+
+			for (auto& buffers : part_buffers)
+			{
+				for (const K* key : buffers[shard])
+				{
+					// Look first: inserting a present key still allocates a node.
+					if (ids.find(*key) == ids.end())
+						ids.insert(std::make_pair(*key, ids.size()));
+				}
+
+				// The buffer is not needed once read.
+				std::vector<const K*>().swap(buffers[shard]);
+			}
+		}
+	}, thread_count, 1);
+
+	std::vector<size_t> shard_firsts(thread_count + 1, 0);
+	for (size_t shard = 0; shard < thread_count; ++shard)
+		shard_firsts[shard + 1] = shard_firsts[shard] + shard_ids[shard].size();
+
+	graph.reserve(graph.get_size() + shard_firsts[thread_count]);
+
+	std::vector<vertex<V, E, P>*> id_vertices(shard_firsts[thread_count]);
+
+	for (size_t shard = 0; shard < thread_count; ++shard)
+	{
+		for (auto& key_id : shard_ids[shard])
+		{
+			vertex<V, E, P>* key_vertex = graph.find_vertex(key_id.first);
+			id_vertices[shard_firsts[shard] + key_id.second] = key_vertex != nullptr ? key_vertex : &graph.add_vertex(key_id.first, vertex_data);
+		}
+	}
+
+	// shard_ids is only read from here on.
+	std::vector<std::array<size_t, 2> > ends(endpoints.size());
+
+	parallel_for(0, endpoints.size(), [&](size_t first, size_t last, size_t)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			for (size_t end = 0; end < 2; ++end)
+			{
+				size_t shard = get_shard(endpoints[i][end]);
+				ends[i][end] = shard_firsts[shard] + shard_ids[shard].find(endpoints[i][end])->second;
+			}
+		}
+	}, thread_count);
+
+	graph.add_edges(id_vertices, ends, edge_data, thread_count);
+}
+
+#endif // GRAPH_BUILDER_H
@@ -0,0 +1,224 @@
+#ifndef KEY_HANDLES_H
+#define KEY_HANDLES_H
+
+#include "Graph.h"
+#include "VertexIndex.h"
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+/** \brief A 32-bit stand-in for an interned key.
+*
+*	Handles are numbered densely from 0 in order of interning.
+*/
+typedef std::uint32_t key_handle;
+
+/** \brief The handle returned for keys which have not been interned.
+*/
+const key_handle no_key_handle = ~key_handle(0);
+
+/** \brief Numbers distinct keys with 32-bit handles.
+*	\tparam K is the type of key.
+*	\tparam H is the hash of K.
+*
+*	Each key is stored once, in a deque whose blocks serve as its arena,
+*	and the handle of a key is its place there, so getting a key back
+*	from its handle is an array access and the reference stays valid
+*	for the life of the interner. Keys are found through an open
+*	addressing table of handles, each beside 32 bits of its key's mixed
+*	hash; the table is probed by those bits and a key is compared only
+*	when they match, and growing the table rehashes no key.\n
+*	Code which refers to keys many times can hold handles instead: a
+*	handle takes 4 bytes whatever the key, and comparing or hashing two
+*	handles is an integer operation. Handles key an interned_graph,
+*	whose index is then a direct_map. With a transparent hash, like
+*	string_key_hash, keys may be interned and found by other types of
+*	key, e.g. std::string_view, which is converted to K only when it is
+*	new.
+*/
+template <typename K, typename H = std::hash<K> >
+class key_interner
+{
+	/** \brief A slot of the table.
+	*/
+	struct slot
+	{
+		/** \brief The handle in the slot, or no_key_handle.
+		*/
+		key_handle handle;
+		/** \brief The low 32 bits of the mixed hash of its key.
+		*/
+		std::uint32_t tag;
+	};
+
+public:
+	/** \brief The default constructor.
+	*/
+	key_interner()
+	: slots(16, empty_slot())
+	{
+
+	}
+
+	/** \brief Retrieve the handle of a key, interning it if need be.
+	*	\param key is the key.
+	*	\return the handle of the key.
+	*
+	*	This function throws std::overflow_error once every handle is
+	*	taken.
+	*/
+	template <typename Q>
+	key_handle intern(const Q& key)
+	{
+		std::uint32_t tag = get_tag(key);
+		size_t position = probe(key, tag);
+
+		if (slots[position].handle != no_key_handle)
+			return slots[position].handle;
+
+		if (keys.size() >= size_t(no_key_handle))
+			throw std::overflow_error("key_interner::intern: out of handles");
+
+		key_handle new_handle = key_handle(keys.size());
+		keys.push_back(K(key));
+
+		slots[position].handle = new_handle;
+		slots[position].tag = tag;
+
+		// Keep the table at most half full.
+		if (2 * keys.size() > slots.size())
+			grow();
+
+		return new_handle;
+	}
+	/** \brief Look for the handle of a key.
+	*	\param key is the key.
+	*	\return the handle of the key, or no_key_handle if it has not
+	*			been interned.
+	*/
+	template <typename Q>
+	key_handle find(const Q& key) const
+	{
+		return slots[probe(key, get_tag(key))].handle;
+	}
+	/** \brief Retrieve the key of a handle.
+	*	\param handle is a handle returned by intern.
+	*	\return the key.
+	*
+	*	This function asserts that the handle was given out.
+	*/
+	const K& get_key(key_handle handle) const
+	{
+		assert(handle < keys.size());
+
+		return keys[handle];
+	}
+
+	/** \brief Retrieve the number of keys interned.
+	*	\return the number of keys, which is one more than the last
+	*			handle given out.
+	*/
+	size_t size() const
+	{
+		return keys.size();
+	}
+	/** \brief Reserves memory for a number of keys.
+	*	\param expected_key_count is the number of keys expected.
+	*/
+	void reserve(size_t expected_key_count)
+	{
+		while (2 * expected_key_count > slots.size())
+			grow();
+	}
+	/** \brief Estimate the memory used by the interner.
+	*	\return the bytes of the keys, what they own (found through
+	*			payload_memory) and the table.
+	*/
+	size_t get_memory() const
+	{
+		size_t memory = keys.size() * sizeof(K) + slots.capacity() * sizeof(slot);
+
+		for (auto& key : keys)
+			memory += payload_memory<K>::get(key);
+
+		return memory;
+	}
+
+private:
+	static slot empty_slot()
+	{
+		slot empty = { no_key_handle, 0 };
+		return empty;
+	}
+
+	/** \brief The low 32 bits of the mixed hash of a key.
+	*/
+	template <typename Q>
+	static std::uint32_t get_tag(const Q& key)
+	{
+		return std::uint32_t(vertex_index_detail::mix(std::uint64_t(H()(key))));
+	}
+	/** \brief Find the slot of a key, or the empty slot where it belongs.
+	*/
+	template <typename Q>
+	size_t probe(const Q& key, std::uint32_t tag) const
+	{
+		size_t mask = slots.size() - 1;
+
+		for (size_t position = tag & mask; ; position = (position + 1) & mask)
+		{
+			const slot& current = slots[position];
+
+			if (current.handle == no_key_handle || (current.tag == tag && keys[current.handle] == key))
+				return position;
+		}
+	}
+	/** \brief Double the table, placing the handles by their tags.
+	*/
+	void grow()
+	{
+		std::vector<slot> old_slots(2 * slots.size(), empty_slot());
+		old_slots.swap(slots);
+
+		size_t mask = slots.size() - 1;
+
+		for (auto& old_slot : old_slots)
+		{
+			if (old_slot.handle == no_key_handle)
+				continue;
+
+			size_t position = old_slot.tag & mask;
+			while (slots[position].handle != no_key_handle)
+				position = (position + 1) & mask;
+
+			slots[position] = old_slot;
+		}
+	}
+
+	/** \brief The keys, indexed by handle.
+	*/
+	std::deque<K> keys;
+	/** \brief The table; its size is a power of two.
+	*/
+	std::vector<slot> slots;
+};
+
+/** \brief A graph keyed by key_handle.
+*	\tparam V is the type of data held by the vertices.
+*	\tparam E is the type of data held by the edges.
+*	\tparam P is the policy; its index defaults to direct_index, which
+*		   suits the dense handles of a key_interner.
+*
+*	Intern the keys with a key_interner and pass their handles to the
+*	graph wherever it takes a key; get_key then returns a handle, which
+*	the interner turns back into the key.
+*/
+template <typename V, typename E, typename P = graph_policy<false, true, false, false, 0, direct_index> >
+using interned_graph = dynamic_sparse_graph<key_handle, std::hash<key_handle>, V, E, P>;
+
+#endif // KEY_HANDLES_H
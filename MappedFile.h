@@ -0,0 +1,139 @@
+
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/** \brief A file mapped read-only into memory.
+*
+*	The mapping is shared, so processes which map the same file share
+*	its pages through the page cache. An empty file is represented by a
+*	null mapping of length 0.
+*/
+class mapped_file
+{
+public:
+	/** \brief The mapped_file constructor.
+	*	\param path is the path of the file to map.
+	*
+	*	A std::runtime_error is thrown if the file cannot be mapped.
+	*/
+	mapped_file(const std::string& path)
+	: address(nullptr), length(0)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("mapped_file: cannot open " + path);
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(file, &size);
+		length = size_t(size.QuadPart);
+
+		if (length == 0)
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr)
+			throw std::runtime_error("mapped_file: cannot map " + path);
+
+		address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (address == nullptr)
+			throw std::runtime_error("mapped_file: cannot map " + path);
+#else
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			throw std::runtime_error("mapped_file: cannot open " + path);
+
+		struct stat status;
+		if (::fstat(file, &status) != 0)
+		{
+			::close(file);
+			throw std::runtime_error("mapped_file: cannot map " + path);
+		}
+		length = size_t(status.st_size);
+
+		if (length == 0)
+		{
+			::close(file);
+			return;
+		}
+
+		void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, file, 0);
+		::close(file);
+		if (mapping == MAP_FAILED)
+			throw std::runtime_error("mapped_file: cannot map " + path);
+
+		address = mapping;
+#endif
+	}
+	/** \brief The move constructor.
+	*	\param rhs is the file to move; it is left empty.
+	*/
+	mapped_file(mapped_file&& rhs)
+	: address(rhs.address), length(rhs.length)
+	{
+		rhs.address = nullptr;
+		rhs.length = 0;
+	}
+	/** \brief The destructor.
+	*
+	*	The file is unmapped.
+	*/
+	~mapped_file()
+	{
+		if (address == nullptr)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(address);
+#else
+		::munmap(address, length);
+#endif
+	}
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	/** \brief Retrieve the first byte of the file.
+	*	\return the first byte of the file, or nullptr if it is empty.
+	*/
+	const char* data() const
+	{
+		return static_cast<const char*>(address);
+	}
+	/** \brief Retrieve the length of the file.
+	*	\return the length of the file in bytes.
+	*/
+	size_t size() const
+	{
+		return length;
+	}
+
+private:
+	/** \brief The start of the mapping.
+	*/
+	void* address;
+	/** \brief The length of the mapping in bytes.
+	*/
+	size_t length;
+};
+
+#endif // MAPPED_FILE_H
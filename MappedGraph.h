@@ -0,0 +1,291 @@
+
+
+#ifndef MAPPED_GRAPH_H
+#define MAPPED_GRAPH_H
+
+#include "Serialization.h"
+#include "MappedFile.h"
+
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include <cstdint>
+
+/** \brief A read-only graph mapped straight from a serialized graph file.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam H is the type of hash generated for K; it must match the
+*			hasher of the graph which was saved.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*
+*	The file written by save_graph is mapped into memory and its
+*	sections are used in place: nothing is copied or built, so opening
+*	a graph takes the same time whatever its size, and processes which
+*	map the same file share its pages through the page cache. Pages are
+*	read from disk as they are first touched.\n
+*	Vertices are addressed by the dense ids of the file, which follow
+*	the iteration order of the saved graph. K, V and E must be trivially
+*	copyable, and the file must be of version 2 or later, which holds
+*	the key index.
+*/
+template <typename K, typename H, typename V, typename E>
+class mapped_graph
+{
+	static_assert(std::is_trivially_copyable<K>::value, "mapped_graph keys must be trivially copyable");
+	static_assert(std::is_trivially_copyable<V>::value, "mapped_graph vertex data must be trivially copyable");
+	static_assert(std::is_trivially_copyable<E>::value, "mapped_graph edge data must be trivially copyable");
+	static_assert(!serialization_detail::holds_address<K>::value && !serialization_detail::holds_address<V>::value
+		&& !serialization_detail::holds_address<E>::value, "mapped_graph keys and data cannot be pointers or views");
+
+public:
+	/** \brief The value returned by find for missing keys.
+	*/
+	static const size_t npos = ~size_t(0);
+
+	/** \brief The mapped_graph constructor.
+	*	\param path is the path of a file written by save_graph.
+	*
+	*	The file is mapped read-only and its header is validated. A
+	*	std::runtime_error is thrown if the file cannot be mapped or is
+	*	not a serialized graph of matching types.
+	*/
+	mapped_graph(const std::string& path)
+	: file(path)
+	{
+		validate();
+	}
+	/** \brief The move constructor.
+	*	\param rhs is the graph to move; it is left without a file.
+	*/
+	mapped_graph(mapped_graph&& rhs)
+	: file(std::move(rhs.file)), header(rhs.header), keys(rhs.keys), vertex_data(rhs.vertex_data),
+	  offsets(rhs.offsets), targets(rhs.targets), edge_ids(rhs.edge_ids), edge_data(rhs.edge_data), index(rhs.index)
+	{
+
+	}
+
+	mapped_graph(const mapped_graph&) = delete;
+	mapped_graph& operator=(const mapped_graph&) = delete;
+
+	/** \brief Retrieve the number of vertices in the graph.
+	*	\return the number of vertices in the graph.
+	*/
+	size_t get_size() const
+	{
+		return header->vertex_count;
+	}
+	/** \brief Retrieve the number of edges in the graph.
+	*	\return the number of edges in the graph.
+	*/
+	size_t get_edge_count() const
+	{
+		return header->edge_count;
+	}
+
+	/** \brief Find the id of the vertex with the given key.
+	*	\param key is the key of the vertex.
+	*	\return the id of the vertex, or npos if there is none.
+	*
+	*	A std::runtime_error is thrown if the probe meets an id out of
+	*	range or finds no empty slot, which only a corrupt file causes.
+	*/
+	size_t find(const K& key) const
+	{
+		std::uint64_t mask = header->index_capacity - 1;
+		std::uint64_t slot = H()(key) & mask;
+
+		for (std::uint64_t probe = 0; probe <= mask; ++probe)
+		{
+			if (index[slot] == graph_file_empty_slot)
+				return npos;
+			if (index[slot] >= header->vertex_count)
+				throw std::runtime_error("mapped_graph: corrupt index");
+			if (keys[index[slot]] == key)
+				return index[slot];
+
+			slot = (slot + 1) & mask;
+		}
+
+		throw std::runtime_error("mapped_graph: corrupt index");
+	}
+	/** \brief Retrieve the id of the vertex with the given key.
+	*	\param key is the key of the vertex.
+	*	\return the id of the vertex.
+	*
+	*	Like dynamic_sparse_graph::get_vertex, this function checks for
+	*	the existence of the vertex and throws std::out_of_range.
+	*/
+	size_t get_id(const K& key) const
+	{
+		size_t id = find(key);
+		if (id == npos)
+			throw std::out_of_range("mapped_graph: no vertex at key");
+
+		return id;
+	}
+	/** \brief Retrieve the key of a vertex.
+	*	\param id is the id of the vertex.
+	*	\return the key of the vertex.
+	*/
+	const K& get_key(size_t id) const
+	{
+		return keys[id];
+	}
+	/** \brief Retrieve the data of a vertex.
+	*	\param id is the id of the vertex.
+	*	\return the data of the vertex.
+	*/
+	const V& get_vertex_data(size_t id) const
+	{
+		return vertex_data[id];
+	}
+	/** \brief Retrieve the number of edges of a vertex.
+	*	\param id is the id of the vertex.
+	*	\return the number of edges of the vertex.
+	*/
+	size_t get_degree(size_t id) const
+	{
+		return offsets[id + 1] - offsets[id];
+	}
+	/** \brief Retrieve a neighbour of a vertex.
+	*	\param id is the id of the vertex.
+	*	\param position is the index of the edge among the vertex's
+	*		   edges, less than get_degree(id).
+	*	\return the id of the neighbour.
+	*/
+	size_t get_neighbor(size_t id, size_t position) const
+	{
+		return targets[offsets[id] + position];
+	}
+	/** \brief Retrieve the data of an edge of a vertex.
+	*	\param id is the id of the vertex.
+	*	\param position is the index of the edge among the vertex's
+	*		   edges, less than get_degree(id).
+	*	\return the data of the edge.
+	*/
+	const E& get_edge_data(size_t id, size_t position) const
+	{
+		return edge_data[edge_ids[offsets[id] + position] >> 1];
+	}
+	/** \brief Retrieve the data of the edge connecting two vertices.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\return the data of the edge connecting the vertices.
+	*
+	*	As with dynamic_sparse_graph::get_edge, this function asserts
+	*	that the keys are not equal and that the edge exists, and checks
+	*	that vertices do indeed exist at the input keys.
+	*/
+	const E& get_edge(const K& key_1, const K& key_2) const
+	{
+		assert(!(key_1 == key_2));
+
+		size_t id_1 = get_id(key_1);
+		size_t id_2 = get_id(key_2);
+
+		std::uint64_t position = offsets[id_1];
+		while (position != offsets[id_1 + 1] && targets[position] != id_2)
+			++position;
+
+		assert(position != offsets[id_1 + 1]);
+
+		return edge_data[edge_ids[position] >> 1];
+	}
+
+private:
+	/** \brief Checks the header and points the sections into the mapping.
+	*/
+	void validate()
+	{
+		if (file.size() < sizeof(graph_file_header))
+			throw std::runtime_error("mapped_graph: not a serialized graph");
+
+		header = reinterpret_cast<const graph_file_header*>(file.data());
+
+		if (std::memcmp(header->magic, "DSGRAPH", 8) != 0)
+			throw std::runtime_error("mapped_graph: not a serialized graph");
+		if (header->byte_order != graph_file_byte_order)
+			throw std::runtime_error("mapped_graph: byte order mismatch");
+		if (header->version < 2 || header->version > graph_file_version)
+			throw std::runtime_error("mapped_graph: unsupported version");
+		if (header->flags != (raw_keys | raw_vertex_data | raw_edge_data)
+			|| header->key_size != sizeof(K) || header->vertex_data_size != sizeof(V) || header->edge_data_size != sizeof(E))
+		{
+			throw std::runtime_error("mapped_graph: type mismatch");
+		}
+
+		// Only the section bounds and the shape of the index are checked,
+		// by division so that no corrupt count can overflow; the rest of
+		// the contents are trusted, but for the ids find() reads.
+		if (header->vertex_count == ~std::uint64_t(0) || header->edge_count > ~std::uint64_t(0) / 2)
+			throw std::runtime_error("mapped_graph: truncated file");
+
+		std::uint64_t entry_count = 2 * header->edge_count;
+
+		if (!fits(header->keys_offset, header->vertex_count, sizeof(K))
+			|| !fits(header->vertex_data_offset, header->vertex_count, sizeof(V))
+			|| !fits(header->offsets_offset, header->vertex_count + 1, sizeof(std::uint64_t))
+			|| !fits(header->targets_offset, entry_count, sizeof(std::uint64_t))
+			|| !fits(header->edge_ids_offset, entry_count, sizeof(std::uint64_t))
+			|| !fits(header->edge_data_offset, header->edge_count, sizeof(E))
+			|| !fits(header->index_offset, header->index_capacity, sizeof(std::uint64_t)))
+		{
+			throw std::runtime_error("mapped_graph: truncated file");
+		}
+
+		// A table with no empty slot would make a failed find() probe
+		// forever.
+		if (header->index_capacity <= header->vertex_count || (header->index_capacity & (header->index_capacity - 1)) != 0)
+			throw std::runtime_error("mapped_graph: corrupt index");
+
+		const char* base = file.data();
+
+		keys = reinterpret_cast<const K*>(base + header->keys_offset);
+		vertex_data = reinterpret_cast<const V*>(base + header->vertex_data_offset);
+		offsets = reinterpret_cast<const std::uint64_t*>(base + header->offsets_offset);
+		targets = reinterpret_cast<const std::uint64_t*>(base + header->targets_offset);
+		edge_ids = reinterpret_cast<const std::uint64_t*>(base + header->edge_ids_offset);
+		edge_data = reinterpret_cast<const E*>(base + header->edge_data_offset);
+		index = reinterpret_cast<const std::uint64_t*>(base + header->index_offset);
+	}
+	/** \brief Checks that a section of count values of size bytes lies
+	*		   within the mapping.
+	*/
+	bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t size) const
+	{
+		return serialization_detail::fits(offset, count, size, file.size());
+	}
+
+	/** \brief The mapped file.
+	*/
+	mapped_file file;
+	/** \brief The header of the file.
+	*/
+	const graph_file_header* header;
+	/** \brief The key of each vertex.
+	*/
+	const K* keys;
+	/** \brief The data of each vertex.
+	*/
+	const V* vertex_data;
+	/** \brief The position in targets of each vertex's first neighbour.
+	*/
+	const std::uint64_t* offsets;
+	/** \brief The neighbours of every vertex.
+	*/
+	const std::uint64_t* targets;
+	/** \brief The edge id of each entry of targets.
+	*/
+	const std::uint64_t* edge_ids;
+	/** \brief The data of each edge.
+	*/
+	const E* edge_data;
+	/** \brief The open-addressing key index.
+	*/
+	const std::uint64_t* index;
+};
+
+#endif // MAPPED_GRAPH_H
@@ -0,0 +1,542 @@
+
+
+#ifndef MUTATION_LOG_H
+#define MUTATION_LOG_H
+
+#include "Graph.h"
+#include "Serialization.h"
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+#include <iterator>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace mutation_log_detail
+{
+	/** \brief Computes the CRC-32 (IEEE) of a byte range.
+	*/
+	inline std::uint32_t crc32(const char* data, size_t size)
+	{
+		struct table
+		{
+			table()
+			{
+				for (std::uint32_t index = 0; index < 256; ++index)
+				{
+					std::uint32_t value = index;
+					for (int bit = 0; bit < 8; ++bit)
+						value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+					entries[index] = value;
+				}
+			}
+
+			std::uint32_t entries[256];
+		};
+
+		static const table crc_table;
+
+		std::uint32_t crc = 0xffffffffu;
+		for (size_t index = 0; index < size; ++index)
+			crc = crc_table.entries[(crc ^ static_cast<unsigned char>(data[index])) & 0xff] ^ (crc >> 8);
+
+		return crc ^ 0xffffffffu;
+	}
+
+	/** \brief Flushes a file to stable storage.
+	*/
+	inline void sync(std::FILE* file)
+	{
+		if (std::fflush(file) != 0)
+			throw std::runtime_error("logged_graph: write failed");
+#ifdef _WIN32
+		_commit(_fileno(file));
+#else
+		::fsync(::fileno(file));
+#endif
+	}
+
+	/** \brief Flushes a closed file or a directory to stable storage.
+	*/
+	inline void sync(const std::string& path)
+	{
+#ifdef _WIN32
+		int file = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+		if (file >= 0)
+		{
+			_commit(file);
+			_close(file);
+		}
+#else
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file >= 0)
+		{
+			::fsync(file);
+			::close(file);
+		}
+#endif
+	}
+
+	/** \brief Atomically replaces the file at to with the file at from.
+	*/
+	inline void replace(const std::string& from, const std::string& to)
+	{
+#ifdef _WIN32
+		bool replaced = MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		bool replaced = std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+		if (!replaced)
+			throw std::runtime_error("logged_graph: cannot replace " + to);
+	}
+
+	/** \brief Cuts a file down to length bytes.
+	*/
+	inline void truncate(const std::string& path, std::uint64_t length)
+	{
+#ifdef _WIN32
+		int file = _open(path.c_str(), _O_RDWR | _O_BINARY);
+		bool truncated = file >= 0 && _chsize_s(file, length) == 0;
+		if (file >= 0)
+			_close(file);
+#else
+		bool truncated = ::truncate(path.c_str(), off_t(length)) == 0;
+#endif
+		if (!truncated)
+			throw std::runtime_error("logged_graph: cannot truncate " + path);
+	}
+}
+
+/** \brief A graph whose mutations are recorded in a write-ahead log.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam H is the type of hash generated by for K.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*	\tparam P is the policy of the graph.
+*
+*	The graph lives in a directory holding two files: "snapshot", a
+*	complete copy of the graph in the serialized graph format prefixed
+*	by the sequence number of the last mutation it contains, and "log",
+*	the mutations made since. Every mutation is first applied to the
+*	in-memory graph and then appended to the log as a record of
+*	\code
+*	std::uint32_t length; std::uint32_t crc32; payload[length]
+*	\endcode
+*	where the payload holds the mutation's sequence number, its kind and
+*	its arguments (written with write_value).\n
+*	Records are group committed: they gather in memory until group_size
+*	of them are pending or commit() is called, and are then written and
+*	flushed to stable storage together, so one flush covers the whole
+*	group. A mutation is only durable once its group is committed.\n
+*	snapshot() writes a new snapshot beside the old one, flushes it,
+*	atomically renames it into place, and only then empties the log, so
+*	a crash at any point leaves a snapshot and a log which together hold
+*	every committed mutation. On construction the snapshot is loaded
+*	and only the records of the log newer than it are replayed; a torn
+*	or corrupt record at the end of the log (an interrupted group) is
+*	cut off.\n
+*	The graph is reachable read-only through get_graph(); changing the
+*	data of vertices and edges must go through set_vertex_data and
+*	set_edge_data so that the change is logged. Keys and data must be
+*	trivially copyable or have a serializer specialization.
+*/
+template <typename K, typename H, typename V, typename E, typename P = graph_policy<> >
+class logged_graph
+{
+	/** \brief The kinds of mutation recorded in the log.
+	*/
+	enum mutation
+	{
+		added_vertex = 1,
+		added_edge = 2,
+		removed_vertex = 3,
+		removed_edge = 4,
+		changed_vertex_data = 5,
+		changed_edge_data = 6
+	};
+
+public:
+	/** \brief The logged_graph constructor.
+	*	\param directory is the existing directory holding the snapshot
+	*		   and log; the graph is recovered from them if present.
+	*	\param group_size is the number of records committed together.
+	*	\param snapshot_interval is the number of mutations after which
+	*		   a snapshot is taken automatically; 0 disables this.
+	*
+	*	A std::runtime_error is thrown if the files cannot be read or
+	*	written.
+	*/
+	logged_graph(const std::string& directory, size_t group_size = 256, size_t snapshot_interval = 0)
+	: directory(directory), group_size(group_size > 0 ? group_size : 1), snapshot_interval(snapshot_interval),
+	  log(nullptr), pending_count(0), sequence(0), snapshot_sequence(0)
+	{
+		recover();
+
+		log = std::fopen(log_path().c_str(), "ab");
+		if (log == nullptr)
+			throw std::runtime_error("logged_graph: cannot open " + log_path());
+	}
+	/** \brief The destructor.
+	*
+	*	Pending records are committed.
+	*/
+	~logged_graph()
+	{
+		try
+		{
+			commit();
+		}
+		catch (...)
+		{
+			;
+		}
+
+		std::fclose(log);
+	}
+
+	logged_graph(const logged_graph&) = delete;
+	logged_graph& operator=(const logged_graph&) = delete;
+
+	/** \brief Adds a vertex to the graph and logs it.
+	*	\param key is the key at which to store the vertex.
+	*	\param vertex_data is the data held by the vertex.
+	*/
+	void add_vertex(const K& key, const V& vertex_data)
+	{
+		graph.add_vertex(key, vertex_data);
+
+		std::ostringstream payload = begin_record(added_vertex);
+		write_value(payload, key);
+		write_value(payload, vertex_data);
+		end_record(payload);
+	}
+	/** \brief Adds an edge to the graph and logs it.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param edge_data is the data held by the edge.
+	*/
+	void add_edge(const K& key_1, const K& key_2, const E& edge_data)
+	{
+		graph.add_edge(key_1, key_2, edge_data);
+
+		std::ostringstream payload = begin_record(added_edge);
+		write_value(payload, key_1);
+		write_value(payload, key_2);
+		write_value(payload, edge_data);
+		end_record(payload);
+	}
+	/** \brief Removes a vertex and its edges from the graph and logs it.
+	*	\param key is the key corresponding to the desired vertex.
+	*/
+	void remove_vertex(const K& key)
+	{
+		graph.remove_vertex(key);
+
+		std::ostringstream payload = begin_record(removed_vertex);
+		write_value(payload, key);
+		end_record(payload);
+	}
+	/** \brief Removes an edge from the graph and logs it.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*/
+	void remove_edge(const K& key_1, const K& key_2)
+	{
+		graph.remove_edge(key_1, key_2);
+
+		std::ostringstream payload = begin_record(removed_edge);
+		write_value(payload, key_1);
+		write_value(payload, key_2);
+		end_record(payload);
+	}
+	/** \brief Replaces the data of a vertex and logs it.
+	*	\param key is the key corresponding to the desired vertex.
+	*	\param vertex_data is the new data of the vertex.
+	*/
+	void set_vertex_data(const K& key, const V& vertex_data)
+	{
+		graph.get_vertex(key).data = vertex_data;
+
+		std::ostringstream payload = begin_record(changed_vertex_data);
+		write_value(payload, key);
+		write_value(payload, vertex_data);
+		end_record(payload);
+	}
+	/** \brief Replaces the data of an edge and logs it.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param edge_data is the new data of the edge.
+	*/
+	void set_edge_data(const K& key_1, const K& key_2, const E& edge_data)
+	{
+		graph.get_edge(key_1, key_2).data = edge_data;
+
+		std::ostringstream payload = begin_record(changed_edge_data);
+		write_value(payload, key_1);
+		write_value(payload, key_2);
+		write_value(payload, edge_data);
+		end_record(payload);
+	}
+
+	/** \brief Writes the pending records and flushes them to stable storage.
+	*/
+	void commit()
+	{
+		if (pending_count == 0)
+			return;
+
+		if (std::fwrite(pending.data(), 1, pending.size(), log) != pending.size())
+			throw std::runtime_error("logged_graph: write failed");
+		mutation_log_detail::sync(log);
+
+		pending.clear();
+		pending_count = 0;
+	}
+	/** \brief Writes a snapshot of the graph and empties the log.
+	*
+	*	Pending records are committed first. Replaying a log after this
+	*	only needs the mutations made since.
+	*/
+	void snapshot()
+	{
+		commit();
+
+		std::string snapshot_path = directory + "/snapshot";
+		std::string temporary_path = snapshot_path + ".tmp";
+
+		{
+			std::ofstream os(temporary_path.c_str(), std::ios::binary | std::ios::trunc);
+			if (!os)
+				throw std::runtime_error("logged_graph: cannot open " + temporary_path);
+
+			os.write("DSGSNAP", 8);
+			os.write(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+			save_graph(graph, os);
+			os.close();
+
+			if (!os)
+				throw std::runtime_error("logged_graph: write failed");
+		}
+
+		mutation_log_detail::sync(temporary_path);
+		mutation_log_detail::replace(temporary_path, snapshot_path);
+		mutation_log_detail::sync(directory);
+
+		// The records are now in the snapshot; a crash before the log is
+		// emptied only leaves records which recovery skips.
+		std::FILE* empty_log = std::freopen(log_path().c_str(), "wb", log);
+		if (empty_log == nullptr)
+			throw std::runtime_error("logged_graph: cannot open " + log_path());
+		log = empty_log;
+		mutation_log_detail::sync(log);
+
+		snapshot_sequence = sequence;
+	}
+
+	/** \brief Retrieve the graph.
+	*	\return the graph.
+	*/
+	const dynamic_sparse_graph<K, H, V, E, P>& get_graph() const
+	{
+		return graph;
+	}
+	/** \brief Retrieve the sequence number of the last mutation.
+	*	\return the sequence number of the last mutation, counting from 1.
+	*/
+	std::uint64_t get_sequence() const
+	{
+		return sequence;
+	}
+
+private:
+	/** \brief Starts the payload of a record.
+	*/
+	std::ostringstream begin_record(mutation kind)
+	{
+		std::ostringstream payload(std::ios::binary);
+
+		std::uint64_t record_sequence = sequence + 1;
+		std::uint8_t record_kind = std::uint8_t(kind);
+
+		payload.write(reinterpret_cast<const char*>(&record_sequence), sizeof(record_sequence));
+		payload.write(reinterpret_cast<const char*>(&record_kind), sizeof(record_kind));
+
+		return payload;
+	}
+	/** \brief Frames a payload and adds it to the pending group.
+	*/
+	void end_record(const std::ostringstream& payload)
+	{
+		std::string bytes = payload.str();
+
+		std::uint32_t length = std::uint32_t(bytes.size());
+		std::uint32_t crc = mutation_log_detail::crc32(bytes.data(), bytes.size());
+
+		pending.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		pending.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+		pending.append(bytes);
+
+		++sequence;
+
+		if (++pending_count >= group_size)
+			commit();
+
+		if (snapshot_interval > 0 && sequence - snapshot_sequence >= snapshot_interval)
+			snapshot();
+	}
+	/** \brief Applies a logged mutation to the graph without logging it.
+	*/
+	void replay(mutation kind, std::istream& is)
+	{
+		switch (kind)
+		{
+		case added_vertex:
+		{
+			K key = read_value<K>(is);
+			graph.add_vertex(key, read_value<V>(is));
+			break;
+		}
+		case added_edge:
+		{
+			K key_1 = read_value<K>(is);
+			K key_2 = read_value<K>(is);
+			graph.add_edge(key_1, key_2, read_value<E>(is));
+			break;
+		}
+		case removed_vertex:
+			graph.remove_vertex(read_value<K>(is));
+			break;
+		case removed_edge:
+		{
+			K key_1 = read_value<K>(is);
+			graph.remove_edge(key_1, read_value<K>(is));
+			break;
+		}
+		case changed_vertex_data:
+		{
+			K key = read_value<K>(is);
+			graph.get_vertex(key).data = read_value<V>(is);
+			break;
+		}
+		case changed_edge_data:
+		{
+			K key_1 = read_value<K>(is);
+			K key_2 = read_value<K>(is);
+			graph.get_edge(key_1, key_2).data = read_value<E>(is);
+			break;
+		}
+		default:
+			throw std::runtime_error("logged_graph: unknown record in " + log_path());
+		}
+	}
+	/** \brief Loads the snapshot and replays the log tail.
+	*/
+	void recover()
+	{
+		std::string snapshot_path = directory + "/snapshot";
+		std::ifstream snapshot_stream(snapshot_path.c_str(), std::ios::binary);
+
+		if (snapshot_stream)
+		{
+			char magic[8];
+			snapshot_stream.read(magic, sizeof(magic));
+			snapshot_stream.read(reinterpret_cast<char*>(&snapshot_sequence), sizeof(snapshot_sequence));
+
+			if (!snapshot_stream || std::memcmp(magic, "DSGSNAP", 8) != 0)
+				throw std::runtime_error("logged_graph: corrupt snapshot " + snapshot_path);
+
+			load_graph(graph, snapshot_stream);
+			sequence = snapshot_sequence;
+		}
+
+		std::ifstream log_stream(log_path().c_str(), std::ios::binary);
+		if (!log_stream)
+			return;
+
+		std::string bytes((std::istreambuf_iterator<char>(log_stream)), std::istreambuf_iterator<char>());
+		log_stream.close();
+
+		size_t position = 0;
+		while (bytes.size() - position >= 2 * sizeof(std::uint32_t))
+		{
+			std::uint32_t length;
+			std::uint32_t crc;
+			std::memcpy(&length, &bytes[position], sizeof(length));
+			std::memcpy(&crc, &bytes[position + sizeof(length)], sizeof(crc));
+
+			const char* payload = &bytes[position + 2 * sizeof(std::uint32_t)];
+
+			if (bytes.size() - position - 2 * sizeof(std::uint32_t) < length
+				|| length < sizeof(std::uint64_t) + sizeof(std::uint8_t)
+				|| mutation_log_detail::crc32(payload, length) != crc)
+			{
+				break;
+			}
+
+			std::uint64_t record_sequence;
+			std::memcpy(&record_sequence, payload, sizeof(record_sequence));
+
+			// Records already in the snapshot are skipped.
+			if (record_sequence > sequence)
+			{
+				std::istringstream is(std::string(payload + sizeof(record_sequence) + 1, length - sizeof(record_sequence) - 1), std::ios::binary);
+				replay(mutation(std::uint8_t(payload[sizeof(record_sequence)])), is);
+				sequence = record_sequence;
+			}
+
+			position += 2 * sizeof(std::uint32_t) + length;
+		}
+
+		// Cut off an interrupted group so that new records follow good ones.
+		if (position != bytes.size())
+			mutation_log_detail::truncate(log_path(), position);
+	}
+	/** \brief Retrieve the path of the log.
+	*/
+	std::string log_path() const
+	{
+		return directory + "/log";
+	}
+
+	/** \brief The directory holding the snapshot and the log.
+	*/
+	std::string directory;
+	/** \brief The number of records committed together.
+	*/
+	size_t group_size;
+	/** \brief The number of mutations between automatic snapshots.
+	*/
+	size_t snapshot_interval;
+	/** \brief The graph.
+	*/
+	dynamic_sparse_graph<K, H, V, E, P> graph;
+	/** \brief The log, open for appending.
+	*/
+	std::FILE* log;
+	/** \brief The framed records of the pending group.
+	*/
+	std::string pending;
+	/** \brief The number of records in the pending group.
+	*/
+	size_t pending_count;
+	/** \brief The sequence number of the last mutation.
+	*/
+	std::uint64_t sequence;
+	/** \brief The sequence number of the last mutation in the snapshot.
+	*/
+	std::uint64_t snapshot_sequence;
+};
+
+#endif // MUTATION_LOG_H
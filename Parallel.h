@@ -0,0 +1,269 @@
+
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/** \brief Retrieve the number of threads used when none is requested.
+*	\return the number of hardware threads, or 1 if it is unknown.
+*/
+inline size_t default_thread_count()
+{
+	size_t thread_count = std::thread::hardware_concurrency();
+
+	return thread_count > 0 ? thread_count : 1;
+}
+
+/** \brief Calls a function on blocks of an index range in parallel.
+*	\param begin is the first index of the range.
+*	\param end is one past the last index of the range.
+*	\param function is called as function(first, last, thread_index)
+*		   for each block [first, last) of the range.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\param grain is the number of indices in a block.
+*
+*	Blocks are handed out dynamically, so ranges whose indices take
+*	uneven amounts of work (e.g. vertices of a power-law graph) remain
+*	balanced. thread_index is in [0, thread_count) and may be used to
+*	select thread-local accumulators. If the range fits in a single
+*	block or only one thread is requested, the function is run on the
+*	calling thread.
+*/
+template <typename F>
+void parallel_for(size_t begin, size_t end, F function, size_t thread_count = 0, size_t grain = 1024)
+{
+	if (begin >= end)
+		return;
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+	if (grain == 0)
+		grain = 1;
+
+	size_t block_count = (end - begin + grain - 1) / grain;
+	thread_count = std::min(thread_count, block_count);
+
+	if (thread_count <= 1)
+	{
+		function(begin, end, size_t(0));
+		return;
+	}
+
+	std::atomic<size_t> next_block(0);
+
+	auto work = [&](size_t thread_index)
+	{
+		size_t block;
+		while ((block = next_block.fetch_add(1)) < block_count)
+		{
+			size_t first = begin + block * grain;
+			function(first, std::min(first + grain, end), thread_index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+
+	for (size_t thread_index = 1; thread_index < thread_count; ++thread_index)
+		threads.emplace_back(work, thread_index);
+
+	work(0);
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+/** \brief Sorts a random access range in parallel.
+*	\param first is the beginning of the range.
+*	\param last is the end of the range.
+*	\param compare is the strict weak ordering used for sorting.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*
+*	The range is split into one run per thread, the runs are sorted
+*	concurrently, and neighbouring runs are then merged pairwise in
+*	parallel until a single run remains. Small ranges are sorted on
+*	the calling thread.
+*/
+template <typename I, typename C>
+void parallel_sort(I first, I last, C compare, size_t thread_count = 0)
+{
+	const size_t minimum_run = 1 << 14;
+
+	size_t size = last - first;
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+	thread_count = std::min(thread_count, std::max(size / minimum_run, size_t(1)));
+
+	if (thread_count <= 1)
+	{
+		std::sort(first, last, compare);
+		return;
+	}
+
+	// bounds[i] is the beginning of the i-th run.
+	std::vector<size_t> bounds;
+	for (size_t run = 0; run <= thread_count; ++run)
+		bounds.push_back(size * run / thread_count);
+
+	parallel_for(0, thread_count, [&](size_t run_first, size_t run_last, size_t)
+	{
+		for (size_t run = run_first; run < run_last; ++run)
+			std::sort(first + bounds[run], first + bounds[run + 1], compare);
+	}, thread_count, 1);
+
+	while (bounds.size() > 2)
+	{
+		size_t merge_count = (bounds.size() - 1) / 2;
+
+		parallel_for(0, merge_count, [&](size_t merge_first, size_t merge_last, size_t)
+		{
+			for (size_t merge = merge_first; merge < merge_last; ++merge)
+				std::inplace_merge(first + bounds[2 * merge], first + bounds[2 * merge + 1], first + bounds[2 * merge + 2], compare);
+		}, merge_count, 1);
+
+		// Drop the bounds which separated the merged runs.
+		std::vector<size_t> merged_bounds;
+		for (size_t bound = 0; bound < bounds.size(); bound += 2)
+			merged_bounds.push_back(bounds[bound]);
+		if (merged_bounds.back() != bounds.back())
+			merged_bounds.push_back(bounds.back());
+
+		bounds.swap(merged_bounds);
+	}
+}
+
+/** \brief Sorts a vector by an unsigned integer key in parallel.
+*	\param values is the vector to sort.
+*	\param key is called as key(value) and returns the value's key.
+*	\param max_key is the largest key of any value.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*
+*	This is a least significant digit radix sort on 8-bit digits, with
+*	as many passes as max_key has significant bytes. In each pass the
+*	vector is split into one block per thread, each thread counts the
+*	digits of its block, and the counts are turned into the place of
+*	each block's first value of each digit so the threads can scatter
+*	their blocks without synchronizing. The sort is stable and takes
+*	a buffer as large as the vector.
+*/
+template <typename T, typename F>
+void parallel_radix_sort(std::vector<T>& values, F key, std::uint64_t max_key, size_t thread_count = 0)
+{
+	const size_t minimum_block = 1 << 14;
+	const size_t radix = 256;
+
+	size_t size = values.size();
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+	size_t block_count = std::min(thread_count, std::max(size / minimum_block, size_t(1)));
+
+	std::vector<T> buffer(size);
+	std::vector<size_t> places(block_count * radix);
+
+	for (unsigned shift = 0; shift < 64 && (max_key >> shift) != 0; shift += 8)
+	{
+		std::fill(places.begin(), places.end(), size_t(0));
+
+		parallel_for(0, block_count, [&](size_t block_first, size_t block_last, size_t)
+		{
+			for (size_t block = block_first; block < block_last; ++block)
+			{
+				size_t* counts = &places[block * radix];
+
+				for (size_t i = size * block / block_count; i < size * (block + 1) / block_count; ++i)
+					++counts[(std::uint64_t(key(values[i])) >> shift) & (radix - 1)];
+			}
+		}, block_count, 1);
+
+		// Order the places by digit and then by block, keeping the sort stable.
+		size_t place = 0;
+		for (size_t digit = 0; digit < radix; ++digit)
+		{
+			for (size_t block = 0; block < block_count; ++block)
+			{
+				size_t count = places[block * radix + digit];
+				places[block * radix + digit] = place;
+				place += count;
+			}
+		}
+
+		parallel_for(0, block_count, [&](size_t block_first, size_t block_last, size_t)
+		{
+			for (size_t block = block_first; block < block_last; ++block)
+			{
+				size_t* next = &places[block * radix];
+
+				for (size_t i = size * block / block_count; i < size * (block + 1) / block_count; ++i)
+					buffer[next[(std::uint64_t(key(values[i])) >> shift) & (radix - 1)]++] = std::move(values[i]);
+			}
+		}, block_count, 1);
+
+		values.swap(buffer);
+	}
+}
+
+/** \brief A lock which waits by spinning rather than sleeping.
+*
+*	It is a single byte wide, so one can be embedded in every vertex.
+*	It is meant for critical sections of a few dozen instructions; a
+*	waiting thread yields its time slice after a short spin. It meets
+*	the Lockable requirements, so it works with std::lock_guard.
+*/
+class spinlock
+{
+public:
+	/** \brief The spinlock constructor.
+	*
+	*	The lock starts unlocked.
+	*/
+	spinlock()
+	{
+		flag.clear();
+	}
+
+	spinlock(const spinlock&) = delete;
+	spinlock& operator=(const spinlock&) = delete;
+
+	/** \brief Acquires the lock, waiting for it if necessary.
+	*/
+	void lock()
+	{
+		for (unsigned attempt = 0; flag.test_and_set(std::memory_order_acquire); ++attempt)
+		{
+			if (attempt >= 64)
+				std::this_thread::yield();
+		}
+	}
+	/** \brief Acquires the lock if it is free.
+	*	\return true if the lock was acquired.
+	*/
+	bool try_lock()
+	{
+		return !flag.test_and_set(std::memory_order_acquire);
+	}
+	/** \brief Releases the lock.
+	*/
+	void unlock()
+	{
+		flag.clear(std::memory_order_release);
+	}
+
+private:
+	/** \brief Set while the lock is held.
+	*/
+	std::atomic_flag flag;
+};
+
+#endif // PARALLEL_H
@@ -0,0 +1,640 @@
+
+
+#ifndef RCU_GRAPH_H
+#define RCU_GRAPH_H
+
+#include "Graph.h"
+#include "Parallel.h"
+#include "Epoch.h"
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+/** \brief A vertex of an rcu_sparse_graph.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*
+*	The inherited edges are the writers' copy, guarded by lock. Readers
+*	use published, an immutable copy which writers replace whole after
+*	each change.
+*/
+template <typename V, typename E>
+struct rcu_vertex : vertex<V, E>
+{
+	/** \brief The type of the readers' adjacency.
+	*/
+	typedef std::vector<edge<V, E>*> adjacency;
+
+	/** \brief The rcu_vertex constructor.
+	*	\param data is the vertex's data.
+	*/
+	rcu_vertex(const V& data)
+	: vertex<V, E>(data), removed(false), published(nullptr)
+	{
+
+	}
+
+	/** \brief Guards edges and removed; only writers take it.
+	*/
+	spinlock lock;
+	/** \brief Set once the vertex has been removed from the graph.
+	*/
+	bool removed;
+	/** \brief The readers' adjacency, or nullptr if there are no edges.
+	*/
+	std::atomic<const adjacency*> published;
+};
+
+/** \brief A dynamic sparse graph whose readers never block.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam H is the type of hash generated by for K.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*	\tparam S is the number of shards of the vertex index.
+*
+*	This is the read-mostly counterpart of concurrent_sparse_graph.
+*	Writers lock as that graph does: a mutex per index shard and a
+*	spinlock per vertex, taken in address order. Readers take no lock at
+*	all; they enter an epoch_domain, look the key up in an index whose
+*	chains are updated with atomic stores, and traverse an adjacency
+*	which writers copy, modify and publish with a single atomic
+*	exchange. Whatever a writer unlinks (index nodes, adjacencies, edges
+*	and vertices) is retired to the domain and deleted only once no
+*	reader can still hold it.\n
+*	Readers therefore see each adjacency as it was at some instant,
+*	possibly just before a concurrent change. Vertex and edge data are
+*	not synchronized and must not be modified once added. The cost is
+*	borne by writers: every edge change copies the adjacencies of both
+*	endpoints.
+*/
+template <typename K, typename H, typename V, typename E, size_t S = 64>
+class rcu_sparse_graph
+{
+public:
+	/** \brief The type of key used for accessing the vertices.
+	*/
+	typedef K key_type;
+	/** \brief The type of vertex stored by the graph.
+	*/
+	typedef rcu_vertex<V, E> vertex_type;
+	/** \brief The type of edge stored by the graph.
+	*/
+	typedef edge<V, E> edge_type;
+
+	/** \brief The default constructor.
+	*/
+	rcu_sparse_graph()
+	: vertex_count(0)
+	{
+		for (auto& current : shards)
+		{
+			current.index.store(new table(8));
+			current.count = 0;
+		}
+	}
+	/** \brief The destructor.
+	*
+	*	Every vertex and edge is deleted; no other thread may be using
+	*	the graph.
+	*/
+	~rcu_sparse_graph()
+	{
+		std::vector<edge<V, E>*> old_edges;
+		std::vector<vertex_type*> old_vertices;
+
+		for (auto& current : shards)
+		{
+			table* index = current.index.load();
+			index->collect(old_vertices);
+			delete index;
+		}
+
+		// Each edge is gathered from its vertices[0] side before any is deleted.
+		for (auto old_vertex : old_vertices)
+		{
+			for (auto old_edge : old_vertex->edges)
+			{
+				if (old_edge->vertices[0] == old_vertex)
+					old_edges.push_back(old_edge);
+			}
+		}
+
+		for (auto old_edge : old_edges)
+			delete old_edge;
+
+		for (auto old_vertex : old_vertices)
+		{
+			delete old_vertex->published.load();
+			delete old_vertex;
+		}
+	}
+
+	rcu_sparse_graph(const rcu_sparse_graph&) = delete;
+	rcu_sparse_graph& operator=(const rcu_sparse_graph&) = delete;
+
+	/** \brief Adds a vertex to the graph.
+	*	\param key is the key at which to store the vertex.
+	*	\param vertex_data is the data held by the vertex.
+	*	\return false if a vertex already exists at the key.
+	*/
+	bool add_vertex(const K& key, const V& vertex_data)
+	{
+		shard& current = get_shard(key);
+		std::lock_guard<std::mutex> guard(current.mutex);
+
+		table* index = current.index.load();
+		if (index->find(key) != nullptr)
+			return false;
+
+		// Grow by publishing a copy; readers of the old table are unaffected.
+		if (current.count >= index->get_capacity())
+		{
+			table* grown = new table(2 * index->get_capacity(), *index);
+			current.index.store(grown);
+			domain.retire(index);
+			index = grown;
+		}
+
+		index->insert(key, new vertex_type(vertex_data));
+		++current.count;
+		++vertex_count;
+
+		return true;
+	}
+	/** \brief Adds an edge to the graph.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param edge_data is the data held by the edge.
+	*	\return false if either vertex does not exist or the keys are
+	*			equal, as the graph has no self loops.
+	*/
+	bool add_edge(const K& key_1, const K& key_2, const E& edge_data)
+	{
+		if (key_1 == key_2)
+			return false;
+
+		epoch_guard reading(domain);
+
+		vertex_type* vertex_1 = find(key_1);
+		vertex_type* vertex_2 = find(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		std::array<vertex<V, E>*, 2> new_edge_vertices = { vertex_1, vertex_2 };
+		edge<V, E>* new_edge = new edge<V, E>(new_edge_vertices, edge_data);
+
+		lock_pair(vertex_1, vertex_2);
+
+		bool added = !vertex_1->removed && !vertex_2->removed;
+		if (added)
+		{
+			vertex_1->edges.push_back(new_edge);
+			vertex_2->edges.push_back(new_edge);
+			publish(vertex_1);
+			publish(vertex_2);
+		}
+
+		unlock_pair(vertex_1, vertex_2);
+
+		if (!added)
+			delete new_edge;
+
+		return added;
+	}
+
+	/** \brief Checks whether a vertex exists.
+	*	\param key is the key of the vertex.
+	*	\return true if a vertex exists at the key.
+	*/
+	bool contains(const K& key)
+	{
+		epoch_guard reading(domain);
+
+		return find(key) != nullptr;
+	}
+	/** \brief Calls a function on a vertex without locking it.
+	*	\param key is the key of the vertex.
+	*	\param function is called as function(vertex).
+	*	\return false if the vertex does not exist.
+	*
+	*	The vertex's edges member is the writers' copy and must not be
+	*	read; use for_each_neighbor instead.
+	*/
+	template <typename F>
+	bool visit_vertex(const K& key, F function)
+	{
+		epoch_guard reading(domain);
+
+		vertex_type* key_vertex = find(key);
+		if (key_vertex == nullptr)
+			return false;
+
+		function(static_cast<const vertex<V, E>&>(*key_vertex));
+		return true;
+	}
+	/** \brief Calls a function on every neighbour of a vertex without
+	*		   locking anything.
+	*	\param key is the key of the vertex.
+	*	\param function is called as function(neighbor, edge) for each
+	*		   edge of the vertex.
+	*	\return false if the vertex does not exist.
+	*
+	*	The edges visited are those published when the call began;
+	*	concurrent changes are not seen, and the neighbours and edges
+	*	stay valid until the call returns even if they are removed.
+	*/
+	template <typename F>
+	bool for_each_neighbor(const K& key, F function)
+	{
+		epoch_guard reading(domain);
+
+		vertex_type* key_vertex = find(key);
+		if (key_vertex == nullptr)
+			return false;
+
+		const typename vertex_type::adjacency* edges = key_vertex->published.load(std::memory_order_acquire);
+		if (edges == nullptr)
+			return true;
+
+		for (auto key_edge : *edges)
+		{
+			const edge<V, E>& current = *key_edge;
+			function(static_cast<const vertex<V, E>&>(*current.vertices[current.vertices[0] == key_vertex]), current);
+		}
+
+		return true;
+	}
+	/** \brief Checks whether two vertices are connected.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\return true if an edge connects the vertices.
+	*/
+	bool has_edge(const K& key_1, const K& key_2)
+	{
+		epoch_guard reading(domain);
+
+		vertex_type* vertex_1 = find(key_1);
+		vertex_type* vertex_2 = find(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		const typename vertex_type::adjacency* edges = vertex_1->published.load(std::memory_order_acquire);
+		if (edges == nullptr)
+			return false;
+
+		return std::any_of(edges->begin(), edges->end(), [&](const edge<V, E>* candidate)
+		{
+			return candidate->vertices[candidate->vertices[0] == vertex_1] == vertex_2;
+		});
+	}
+	/** \brief Retrieve the number of edges of a vertex.
+	*	\param key is the key of the vertex.
+	*	\return the number of edges of the vertex, or 0 if it does not
+	*			exist.
+	*/
+	size_t get_degree(const K& key)
+	{
+		epoch_guard reading(domain);
+
+		vertex_type* key_vertex = find(key);
+		if (key_vertex == nullptr)
+			return 0;
+
+		const typename vertex_type::adjacency* edges = key_vertex->published.load(std::memory_order_acquire);
+		return edges != nullptr ? edges->size() : 0;
+	}
+	/** \brief Retrieve the number of vertices in the graph.
+	*	\return the number of vertices in the graph.
+	*/
+	size_t get_size() const
+	{
+		return vertex_count;
+	}
+
+	/** \brief Removes a vertex and its edges from the graph.
+	*	\param key is the key corresponding to the desired vertex.
+	*	\return false if the vertex does not exist.
+	*
+	*	The vertex is unlinked from the index and marked removed, its
+	*	edges are removed one neighbour at a time, and the vertex is
+	*	retired.
+	*/
+	bool remove_vertex(const K& key)
+	{
+		// Neighbours removed meanwhile must outlive this call.
+		epoch_guard reading(domain);
+
+		vertex_type* old_vertex;
+
+		shard& current = get_shard(key);
+		{
+			std::lock_guard<std::mutex> guard(current.mutex);
+
+			old_vertex = current.index.load()->erase(key, domain);
+			if (old_vertex == nullptr)
+				return false;
+
+			--current.count;
+		}
+
+		--vertex_count;
+
+		old_vertex->lock.lock();
+		old_vertex->removed = true;
+
+		while (!old_vertex->edges.empty())
+		{
+			edge<V, E>* old_edge = old_vertex->edges.back();
+			vertex_type* connected_vertex = other(old_edge, old_vertex);
+
+			// Lock the pair in address order; the edge may go meanwhile.
+			old_vertex->lock.unlock();
+			lock_pair(old_vertex, connected_vertex);
+
+			bool owned = unlink(old_vertex, old_edge);
+			if (owned)
+			{
+				unlink(connected_vertex, old_edge);
+				publish(connected_vertex);
+				domain.retire(old_edge);
+			}
+
+			connected_vertex->lock.unlock();
+		}
+
+		publish(old_vertex);
+		old_vertex->lock.unlock();
+
+		domain.retire(old_vertex);
+
+		return true;
+	}
+	/** \brief Removes the edge connecting two vertices.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\return false if there is no such edge.
+	*/
+	bool remove_edge(const K& key_1, const K& key_2)
+	{
+		epoch_guard reading(domain);
+
+		vertex_type* vertex_1 = find(key_1);
+		vertex_type* vertex_2 = find(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		lock_pair(vertex_1, vertex_2);
+
+		auto edge_it = std::find_if(vertex_1->edges.begin(), vertex_1->edges.end(), [&](edge<V, E>* candidate)
+		{
+			return other(candidate, vertex_1) == vertex_2;
+		});
+
+		edge<V, E>* old_edge = nullptr;
+		if (edge_it != vertex_1->edges.end())
+		{
+			old_edge = *edge_it;
+			unlink(vertex_1, old_edge);
+			unlink(vertex_2, old_edge);
+			publish(vertex_1);
+			publish(vertex_2);
+		}
+
+		unlock_pair(vertex_1, vertex_2);
+
+		domain.retire(old_edge);
+
+		return old_edge != nullptr;
+	}
+
+	/** \brief Deletes whatever retired memory no reader can still hold.
+	*
+	*	Reclamation also happens as a matter of course during writes;
+	*	this is for freeing memory promptly after a burst of them.
+	*/
+	void reclaim()
+	{
+		domain.reclaim();
+	}
+
+private:
+	/** \brief An entry of an index chain.
+	*/
+	struct node
+	{
+		node(const K& key, vertex_type* value, node* next)
+		: key(key), value(value), next(next)
+		{
+
+		}
+
+		const K key;
+		vertex_type* const value;
+		std::atomic<node*> next;
+	};
+	/** \brief A chained hash table read without locks.
+	*
+	*	Only the shard's writer changes it, one atomic store at a time,
+	*	so a reader always sees well-formed chains.
+	*/
+	class table
+	{
+	public:
+		table(size_t capacity)
+		: buckets(new std::atomic<node*>[capacity]), mask(capacity - 1)
+		{
+			for (size_t i = 0; i < capacity; ++i)
+				buckets[i].store(nullptr, std::memory_order_relaxed);
+		}
+		table(size_t capacity, const table& rhs)
+		: table(capacity)
+		{
+			for (size_t i = 0; i <= rhs.mask; ++i)
+			{
+				for (node* current = rhs.buckets[i].load(); current != nullptr; current = current->next.load())
+					insert(current->key, current->value);
+			}
+		}
+		~table()
+		{
+			for (size_t i = 0; i <= mask; ++i)
+			{
+				node* current = buckets[i].load();
+				while (current != nullptr)
+				{
+					node* next = current->next.load();
+					delete current;
+					current = next;
+				}
+			}
+		}
+
+		size_t get_capacity() const
+		{
+			return mask + 1;
+		}
+		vertex_type* find(const K& key) const
+		{
+			node* current = buckets[slot(key)].load(std::memory_order_acquire);
+			while (current != nullptr && !(current->key == key))
+				current = current->next.load(std::memory_order_acquire);
+
+			return current != nullptr ? current->value : nullptr;
+		}
+		void insert(const K& key, vertex_type* value)
+		{
+			std::atomic<node*>& head = buckets[slot(key)];
+			head.store(new node(key, value, head.load()), std::memory_order_release);
+		}
+		vertex_type* erase(const K& key, epoch_domain& domain)
+		{
+			std::atomic<node*>* link = &buckets[slot(key)];
+			node* current = link->load();
+			while (current != nullptr && !(current->key == key))
+			{
+				link = &current->next;
+				current = link->load();
+			}
+
+			if (current == nullptr)
+				return nullptr;
+
+			link->store(current->next.load(), std::memory_order_release);
+			domain.retire(current);
+
+			return current->value;
+		}
+		void collect(std::vector<vertex_type*>& values) const
+		{
+			for (size_t i = 0; i <= mask; ++i)
+			{
+				for (node* current = buckets[i].load(); current != nullptr; current = current->next.load())
+					values.push_back(current->value);
+			}
+		}
+
+	private:
+		/** \brief The bucket of a key, from the low bits of its mixed
+		*		   hash; its shard was chosen by the high bits.
+		*/
+		size_t slot(const K& key) const
+		{
+			return size_t(get_hash(key)) & mask;
+		}
+
+		std::unique_ptr<std::atomic<node*>[]> buckets;
+		size_t mask;
+	};
+	/** \brief A part of the vertex index, on its own cache line.
+	*/
+	struct alignas(64) shard
+	{
+		/** \brief Serializes the shard's writers.
+		*/
+		std::mutex mutex;
+		/** \brief The published table.
+		*/
+		std::atomic<table*> index;
+		/** \brief The number of vertices in the shard; writers only.
+		*/
+		size_t count;
+	};
+
+	/** \brief Retrieve the mixed hash of a key.
+	*
+	*	Its high 32 bits pick the shard and its low bits the bucket, so
+	*	the keys of a shard spread over every bucket of its table.
+	*/
+	static std::uint64_t get_hash(const K& key)
+	{
+		return vertex_index_detail::mix(std::uint64_t(H()(key)));
+	}
+	/** \brief Retrieve the shard responsible for a key.
+	*/
+	shard& get_shard(const K& key)
+	{
+		return shards[size_t((get_hash(key) >> 32) * S >> 32)];
+	}
+	/** \brief Look up a vertex, or nullptr; the caller must be inside
+	*		   the domain.
+	*/
+	vertex_type* find(const K& key)
+	{
+		return get_shard(key).index.load(std::memory_order_acquire)->find(key);
+	}
+	/** \brief Publish a copy of a vertex's edges; its lock must be held.
+	*/
+	void publish(vertex_type* some_vertex)
+	{
+		const typename vertex_type::adjacency* edges = nullptr;
+		if (!some_vertex->edges.empty())
+			edges = new typename vertex_type::adjacency(some_vertex->edges);
+
+		domain.retire(some_vertex->published.exchange(edges, std::memory_order_acq_rel));
+	}
+	/** \brief Retrieve the other end of an edge.
+	*/
+	static vertex_type* other(edge<V, E>* some_edge, vertex<V, E>* some_vertex)
+	{
+		return static_cast<vertex_type*>(some_edge->vertices[some_edge->vertices[0] == some_vertex]);
+	}
+	/** \brief Remove an edge from a vertex's writers' copy.
+	*	\return false if the vertex did not have the edge.
+	*/
+	static bool unlink(vertex_type* some_vertex, edge<V, E>* old_edge)
+	{
+		auto edge_it = std::find(some_vertex->edges.begin(), some_vertex->edges.end(), old_edge);
+		if (edge_it == some_vertex->edges.end())
+			return false;
+
+		*edge_it = some_vertex->edges.back();
+		some_vertex->edges.pop_back();
+
+		return true;
+	}
+	/** \brief Lock two vertices in address order.
+	*
+	*	A vertex passed twice is locked once, as its lock is not
+	*	recursive.
+	*/
+	static void lock_pair(vertex_type* vertex_1, vertex_type* vertex_2)
+	{
+		if (std::less<vertex_type*>()(vertex_2, vertex_1))
+			std::swap(vertex_1, vertex_2);
+
+		vertex_1->lock.lock();
+		if (vertex_2 != vertex_1)
+			vertex_2->lock.lock();
+	}
+	/** \brief Unlock two vertices locked by lock_pair.
+	*/
+	static void unlock_pair(vertex_type* vertex_1, vertex_type* vertex_2)
+	{
+		vertex_1->lock.unlock();
+		if (vertex_2 != vertex_1)
+			vertex_2->lock.unlock();
+	}
+
+	/** \brief The domain to which unlinked memory is retired.
+	*
+	*	It is declared first so that it is destroyed last.
+	*/
+	epoch_domain domain;
+	/** \brief The number of vertices contained by the graph.
+	*/
+	std::atomic<size_t> vertex_count;
+	/** \brief The shards of the vertex index.
+	*/
+	std::array<shard, S> shards;
+};
+
+#endif // RCU_GRAPH_H
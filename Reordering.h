@@ -0,0 +1,320 @@
+
+
+#ifndef REORDERING_H
+#define REORDERING_H
+
+#include "Graph.h"
+#include "CompactGraph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+/*	The orderings below renumber the vertices of a compact_graph so that
+*	vertices used together get nearby ids. Each returns a permutation as
+*	the list of current dense ids in their new order: entry i is the id
+*	of the vertex which becomes vertex i. Pass it to
+*	reorder_compact_graph to renumber a snapshot, or pass the reordered
+*	snapshot's vertices to dynamic_sparse_graph::compact to lay out the
+*	graph's own storage in the same order.
+*/
+
+namespace reordering_detail
+{
+	/** \brief Append the vertices reached by a breadth-first search from
+	*		   a root to an order.
+	*	\param by_degree is whether to visit each vertex's unvisited
+	*		   neighbours in increasing order of degree.
+	*/
+	template <typename K, typename V, typename E, typename P>
+	void breadth_first_search(const compact_graph<K, V, E, P>& compact, size_t root, bool by_degree, std::vector<bool>& visited, std::vector<size_t>& order)
+	{
+		// order doubles as the queue of the search.
+		size_t head = order.size();
+		visited[root] = true;
+		order.push_back(root);
+
+		while (head < order.size())
+		{
+			size_t current = order[head++];
+			size_t first_new = order.size();
+
+			for (size_t position = compact.offsets[current]; position < compact.offsets[current + 1]; ++position)
+			{
+				size_t neighbor = compact.targets[position];
+				if (!visited[neighbor])
+				{
+					visited[neighbor] = true;
+					order.push_back(neighbor);
+				}
+			}
+
+			if (by_degree)
+			{
+				std::stable_sort(order.begin() + first_new, order.end(), [&](size_t lhs, size_t rhs)
+				{
+					return compact.get_degree(lhs) < compact.get_degree(rhs);
+				});
+			}
+		}
+	}
+}
+
+/** \brief Order the vertices of a snapshot breadth first.
+*	\param compact is the snapshot to order.
+*	\return the dense ids in their new order.
+*
+*	Each search starts from the lowest unvisited id, so every connected
+*	component gets a contiguous range of ids. Takes O(V + E) time.
+*/
+template <typename K, typename V, typename E, typename P>
+std::vector<size_t> breadth_first_order(const compact_graph<K, V, E, P>& compact)
+{
+	std::vector<size_t> order;
+	order.reserve(compact.get_size());
+
+	std::vector<bool> visited(compact.get_size(), false);
+
+	for (size_t root = 0; root < compact.get_size(); ++root)
+	{
+		if (!visited[root])
+			reordering_detail::breadth_first_search(compact, root, false, visited, order);
+	}
+
+	return order;
+}
+/** \brief Order the vertices of a snapshot by reverse Cuthill-McKee.
+*	\param compact is the snapshot to order.
+*	\return the dense ids in their new order.
+*
+*	Each component is searched breadth first from one of its vertices
+*	of least degree, visiting neighbours in increasing order of degree,
+*	and the whole order is then reversed. This keeps the ids of
+*	neighbours close, i.e. it reduces the bandwidth of the adjacency
+*	matrix. Takes O(V log V + E log D) time, D being the largest degree.
+*/
+template <typename K, typename V, typename E, typename P>
+std::vector<size_t> reverse_cuthill_mckee_order(const compact_graph<K, V, E, P>& compact)
+{
+	size_t vertex_count = compact.get_size();
+
+	std::vector<size_t> roots(vertex_count);
+	for (size_t id = 0; id < vertex_count; ++id)
+		roots[id] = id;
+
+	std::stable_sort(roots.begin(), roots.end(), [&](size_t lhs, size_t rhs)
+	{
+		return compact.get_degree(lhs) < compact.get_degree(rhs);
+	});
+
+	std::vector<size_t> order;
+	order.reserve(vertex_count);
+
+	std::vector<bool> visited(vertex_count, false);
+
+	for (auto root : roots)
+	{
+		if (!visited[root])
+			reordering_detail::breadth_first_search(compact, root, true, visited, order);
+	}
+
+	std::reverse(order.begin(), order.end());
+
+	return order;
+}
+/** \brief Order the vertices of a snapshot by degree.
+*	\param compact is the snapshot to order.
+*	\param descending is whether the vertices of highest degree come
+*		   first.
+*	\return the dense ids in their new order.
+*
+*	Grouping the hubs together keeps the most visited vertices in the
+*	fewest cache lines. Ties keep their current order.
+*/
+template <typename K, typename V, typename E, typename P>
+std::vector<size_t> degree_order(const compact_graph<K, V, E, P>& compact, bool descending = true)
+{
+	std::vector<size_t> order(compact.get_size());
+	for (size_t id = 0; id < order.size(); ++id)
+		order[id] = id;
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
+	{
+		return descending
+			? compact.get_degree(lhs) > compact.get_degree(rhs)
+			: compact.get_degree(lhs) < compact.get_degree(rhs);
+	});
+
+	return order;
+}
+/** \brief Order the vertices of a snapshot greedily, after Gorder.
+*	\param compact is the snapshot to order.
+*	\param window is the number of most recently placed vertices a
+*		   candidate is compared with.
+*	\param hub_degree is the degree above which a vertex is not used
+*		   to relate its neighbours to each other; 0 means no limit.
+*	\return the dense ids in their new order.
+*
+*	The next vertex placed is the one with the highest score against
+*	the last window vertices placed, scoring one for each of them it is
+*	adjacent to and one for each neighbour it shares with them. When no
+*	unplaced vertex scores, the unplaced vertex of highest degree comes
+*	next. Each placement updates the scores of the vertices within two
+*	hops, so this takes O(V log V + sum of squared degrees) time;
+*	hub_degree bounds the cost on graphs with a few huge hubs.
+*/
+template <typename K, typename V, typename E, typename P>
+std::vector<size_t> gorder_order(const compact_graph<K, V, E, P>& compact, size_t window = 5, size_t hub_degree = 0)
+{
+	size_t vertex_count = compact.get_size();
+
+	std::vector<size_t> order;
+	order.reserve(vertex_count);
+
+	std::vector<size_t> scores(vertex_count, 0);
+	std::vector<bool> placed(vertex_count, false);
+
+	// Candidates by score; entries go stale when a score drops and are
+	// checked against scores when they come out.
+	std::priority_queue<std::pair<size_t, size_t> > candidates;
+
+	std::vector<size_t> by_degree = degree_order(compact);
+	size_t next_by_degree = 0;
+
+	// Raise or lower the score of every unplaced vertex within two hops
+	// of id as it enters or leaves the window.
+	auto update = [&](size_t id, bool entering)
+	{
+		auto adjust = [&](size_t other)
+		{
+			if (placed[other])
+				return;
+
+			if (entering)
+			{
+				++scores[other];
+				candidates.push(std::make_pair(scores[other], other));
+			}
+			else
+			{
+				--scores[other];
+			}
+		};
+
+		for (size_t position = compact.offsets[id]; position < compact.offsets[id + 1]; ++position)
+		{
+			size_t neighbor = compact.targets[position];
+			adjust(neighbor);
+
+			if (hub_degree != 0 && compact.get_degree(neighbor) > hub_degree)
+				continue;
+
+			for (size_t second = compact.offsets[neighbor]; second < compact.offsets[neighbor + 1]; ++second)
+			{
+				if (compact.targets[second] != id)
+					adjust(compact.targets[second]);
+			}
+		}
+	};
+
+	while (order.size() < vertex_count)
+	{
+		size_t next = vertex_count;
+
+		while (!candidates.empty() && next == vertex_count)
+		{
+			std::pair<size_t, size_t> candidate = candidates.top();
+			candidates.pop();
+
+			if (placed[candidate.second] || scores[candidate.second] == 0)
+				continue;
+
+			if (candidate.first == scores[candidate.second])
+				next = candidate.second;
+			else if (candidate.first > scores[candidate.second])
+				candidates.push(std::make_pair(scores[candidate.second], candidate.second));
+		}
+
+		if (next == vertex_count)
+		{
+			while (placed[by_degree[next_by_degree]])
+				++next_by_degree;
+
+			next = by_degree[next_by_degree];
+		}
+
+		placed[next] = true;
+		order.push_back(next);
+
+		update(next, true);
+		if (order.size() > window)
+			update(order[order.size() - window - 1], false);
+	}
+
+	return order;
+}
+
+/** \brief Renumber the vertices of a snapshot.
+*	\param compact is the snapshot to renumber.
+*	\param order is every dense id of the snapshot, each once, in the
+*		   new order, as returned by the orderings above.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the renumbered snapshot, in which the vertex with id i is
+*			the vertex which had id order[i].
+*
+*	Each adjacency list keeps its entries in their current order. The
+*	vertices of the result may be passed to
+*	dynamic_sparse_graph::compact to relocate the graph itself in the
+*	new order.
+*/
+template <typename K, typename V, typename E, typename P>
+compact_graph<K, V, E, P> reorder_compact_graph(const compact_graph<K, V, E, P>& compact, const std::vector<size_t>& order, size_t thread_count = 0)
+{
+	size_t vertex_count = compact.get_size();
+
+	assert(order.size() == vertex_count);
+
+	std::vector<size_t> new_ids(vertex_count);
+	for (size_t new_id = 0; new_id < vertex_count; ++new_id)
+		new_ids[order[new_id]] = new_id;
+
+	compact_graph<K, V, E, P> reordered;
+
+	reordered.keys.reserve(vertex_count);
+	reordered.vertices.reserve(vertex_count);
+	reordered.offsets.resize(vertex_count + 1);
+
+	reordered.offsets[0] = 0;
+	for (size_t new_id = 0; new_id < vertex_count; ++new_id)
+	{
+		reordered.keys.push_back(compact.keys[order[new_id]]);
+		reordered.vertices.push_back(compact.vertices[order[new_id]]);
+		reordered.offsets[new_id + 1] = reordered.offsets[new_id] + compact.get_degree(order[new_id]);
+	}
+
+	reordered.targets.resize(reordered.offsets[vertex_count]);
+	reordered.edges.resize(reordered.offsets[vertex_count]);
+
+	parallel_for(0, vertex_count, [&](size_t first, size_t last, size_t)
+	{
+		for (size_t new_id = first; new_id < last; ++new_id)
+		{
+			size_t position = reordered.offsets[new_id];
+
+			for (size_t old_position = compact.offsets[order[new_id]]; old_position < compact.offsets[order[new_id] + 1]; ++old_position)
+			{
+				reordered.targets[position] = new_ids[compact.targets[old_position]];
+				reordered.edges[position] = compact.edges[old_position];
+				++position;
+			}
+		}
+	}, thread_count);
+
+	return reordered;
+}
+
+#endif // REORDERING_H
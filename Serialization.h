@@ -0,0 +1,697 @@
+
+
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+#include "Graph.h"
+#include "CompactGraph.h"
+
+#include <vector>
+#include <array>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+/** \brief Writes and reads values which cannot be copied byte for byte.
+*	\tparam T is the type of value.
+*
+*	save_graph and load_graph store keys, vertex data and edge data of
+*	trivially copyable types as raw arrays. Any other type needs a
+*	specialization of this struct providing
+*	\code
+*	static void write(std::ostream& os, const T& value);
+*	static T read(std::istream& is);
+*	\endcode
+*	A specialization for std::string is provided. Pointers and
+*	std::string_view are rejected at compile time, as the memory they
+*	refer to is not written; a graph keyed by views of a string_pool
+*	must be copied to std::string keys to be saved or logged.
+*/
+template <typename T>
+struct serializer;
+
+/** \brief Writes and reads strings as a length followed by characters.
+*/
+template <>
+struct serializer<std::string>
+{
+	static void write(std::ostream& os, const std::string& value)
+	{
+		std::uint64_t length = value.size();
+		os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+		os.write(value.data(), value.size());
+	}
+
+	static std::string read(std::istream& is)
+	{
+		std::uint64_t length = 0;
+		is.read(reinterpret_cast<char*>(&length), sizeof(length));
+
+		// Grow by chunks, so a corrupt length fails at the end of the
+		// stream rather than allocating it all up front.
+		std::string value;
+		while (is && value.size() < length)
+		{
+			size_t old_size = value.size();
+			size_t chunk = size_t(std::min(length - old_size, std::uint64_t(1) << 16));
+
+			value.resize(old_size + chunk);
+			is.read(&value[old_size], chunk);
+		}
+
+		return value;
+	}
+};
+
+namespace serialization_detail
+{
+	/** \brief Whether values of T refer to memory outside themselves,
+	*		   and so cannot be written.
+	*/
+	template <typename T>
+	struct holds_address : std::integral_constant<bool, std::is_pointer<T>::value || std::is_member_pointer<T>::value>
+	{
+
+	};
+
+#if __cplusplus >= 201703L
+	template <typename C, typename T>
+	struct holds_address<std::basic_string_view<C, T> > : std::true_type
+	{
+
+	};
+#endif
+
+	template <typename T>
+	void write_value(std::ostream& os, const T& value, std::true_type)
+	{
+		os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	void write_value(std::ostream& os, const T& value, std::false_type)
+	{
+		serializer<T>::write(os, value);
+	}
+
+	template <typename T>
+	T read_value(std::istream& is, std::true_type)
+	{
+		T value;
+		is.read(reinterpret_cast<char*>(&value), sizeof(T));
+
+		return value;
+	}
+
+	template <typename T>
+	T read_value(std::istream& is, std::false_type)
+	{
+		return serializer<T>::read(is);
+	}
+}
+
+/** \brief Writes a single value.
+*	\param os is the binary stream to write to.
+*	\param value is the value to write.
+*
+*	The value is written raw if it is trivially copyable and through
+*	serializer otherwise, as in save_graph.
+*/
+template <typename T>
+void write_value(std::ostream& os, const T& value)
+{
+	static_assert(!serialization_detail::holds_address<T>::value, "write_value: pointers and views cannot be written");
+
+	serialization_detail::write_value(os, value, typename std::is_trivially_copyable<T>::type());
+}
+
+/** \brief Reads a single value written by write_value.
+*	\param is is the binary stream to read from.
+*	\return the value read.
+*/
+template <typename T>
+T read_value(std::istream& is)
+{
+	static_assert(!serialization_detail::holds_address<T>::value, "read_value: pointers and views cannot be read");
+
+	return serialization_detail::read_value<T>(is, typename std::is_trivially_copyable<T>::type());
+}
+
+/** \brief The header at the start of a serialized graph.
+*
+*	A file holds the header followed by the sections it points to, each
+*	starting at a multiple of graph_file_alignment bytes:
+*	- keys: a raw array of vertex_count keys, or serializer records.
+*	- vertex data: likewise, one per vertex.
+*	- offsets: vertex_count + 1 std::uint64_t, as in compact_graph.
+*	- targets: 2 * edge_count std::uint64_t neighbour ids, or
+*	  edge_count if the directed_edges flag is set, as each edge is then
+*	  listed only by the vertex it leads from.
+*	- edge ids: as many std::uint64_t, parallel to targets. Bits 1 and
+*	  up are the index of the edge's data; bit 0 is set if the
+*	  neighbour, rather than the vertex, is the edge's vertices[0].
+*	- edge data: a raw array of edge_count values, or serializer records.
+*	- index (version 2): when keys are raw, an open-addressing hash
+*	  table of index_capacity std::uint64_t vertex ids, a power of two
+*	  at least twice vertex_count. A key's probe sequence starts at its
+*	  hash modulo index_capacity and proceeds linearly; empty slots hold
+*	  graph_file_empty_slot. It lets mapped_graph look keys up without
+*	  building anything at startup.
+*
+*	Every number is in the byte order of the machine which wrote the
+*	file; byte_order tells a reader whether that matches its own.
+*/
+struct graph_file_header
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byte_order;
+	std::uint32_t flags;
+	std::uint32_t reserved;
+	std::uint64_t vertex_count;
+	std::uint64_t edge_count;
+	std::uint64_t key_size;
+	std::uint64_t vertex_data_size;
+	std::uint64_t edge_data_size;
+	std::uint64_t keys_offset;
+	std::uint64_t keys_length;
+	std::uint64_t vertex_data_offset;
+	std::uint64_t vertex_data_length;
+	std::uint64_t offsets_offset;
+	std::uint64_t targets_offset;
+	std::uint64_t edge_ids_offset;
+	std::uint64_t edge_data_offset;
+	std::uint64_t edge_data_length;
+	std::uint64_t index_offset;
+	std::uint64_t index_capacity;
+};
+
+/** \brief The current version of the serialized graph format.
+*/
+const std::uint32_t graph_file_version = 2;
+/** \brief The value of graph_file_header::byte_order when it is read
+*		   on a machine of the same byte order as the writer.
+*/
+const std::uint32_t graph_file_byte_order = 0x01020304;
+/** \brief The boundary to which every section is aligned.
+*/
+const std::uint64_t graph_file_alignment = 64;
+/** \brief The value of an empty slot of the key index.
+*/
+const std::uint64_t graph_file_empty_slot = ~std::uint64_t(0);
+/** \brief The flags of graph_file_header::flags.
+*/
+enum graph_file_flags
+{
+	raw_keys = 1,
+	raw_vertex_data = 2,
+	raw_edge_data = 4,
+	directed_edges = 8
+};
+
+namespace serialization_detail
+{
+	inline std::uint64_t align(std::uint64_t position)
+	{
+		return (position + graph_file_alignment - 1) / graph_file_alignment * graph_file_alignment;
+	}
+
+	/** \brief Encodes a section of values, raw if possible.
+	*/
+	template <typename T>
+	std::string encode(const std::vector<const T*>& values, std::true_type)
+	{
+		std::string bytes(values.size() * sizeof(T), '\0');
+
+		for (size_t index = 0; index < values.size(); ++index)
+			std::memcpy(&bytes[index * sizeof(T)], values[index], sizeof(T));
+
+		return bytes;
+	}
+
+	template <typename T>
+	std::string encode(const std::vector<const T*>& values, std::false_type)
+	{
+		std::ostringstream os(std::ios::binary);
+
+		for (auto value : values)
+			serializer<T>::write(os, *value);
+
+		return os.str();
+	}
+
+	/** \brief Decodes a section of count values, raw if possible.
+	*/
+	template <typename T>
+	std::vector<T> decode(std::istream& is, std::uint64_t count, std::uint64_t, std::true_type)
+	{
+		std::vector<T> values(count);
+
+		if (count > 0)
+			is.read(reinterpret_cast<char*>(&values[0]), count * sizeof(T));
+
+		return values;
+	}
+
+	template <typename T>
+	std::vector<T> decode(std::istream& is, std::uint64_t count, std::uint64_t length, std::false_type)
+	{
+		std::string bytes(length, '\0');
+		if (length > 0)
+			is.read(&bytes[0], length);
+
+		std::istringstream section(bytes, std::ios::binary);
+
+		// A corrupt count must not reserve more than the section could hold.
+		std::vector<T> values;
+		values.reserve(std::min(count, length));
+		for (std::uint64_t index = 0; index < count; ++index)
+			values.push_back(serializer<T>::read(section));
+
+		if (!section)
+			throw std::runtime_error("load_graph: corrupt section");
+
+		return values;
+	}
+
+	template <typename T>
+	void write_array(std::ostream& os, const std::vector<T>& values)
+	{
+		if (!values.empty())
+			os.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(T));
+	}
+
+	template <typename T>
+	void read_array(std::istream& is, std::vector<T>& values, std::uint64_t count)
+	{
+		values.resize(count);
+		if (count > 0)
+			is.read(reinterpret_cast<char*>(&values[0]), count * sizeof(T));
+	}
+
+	/** \brief Builds the key index of a file with raw keys.
+	*/
+	template <typename K, typename H>
+	std::vector<std::uint64_t> make_index(const std::vector<const K*>& keys, std::true_type)
+	{
+		std::uint64_t capacity = 1;
+		while (capacity < 2 * keys.size())
+			capacity <<= 1;
+
+		std::vector<std::uint64_t> slots(capacity, graph_file_empty_slot);
+		H hasher;
+
+		for (std::uint64_t id = 0; id < keys.size(); ++id)
+		{
+			std::uint64_t slot = hasher(*keys[id]) & (capacity - 1);
+			while (slots[slot] != graph_file_empty_slot)
+				slot = (slot + 1) & (capacity - 1);
+
+			slots[slot] = id;
+		}
+
+		return slots;
+	}
+
+	template <typename K, typename H>
+	std::vector<std::uint64_t> make_index(const std::vector<const K*>&, std::false_type)
+	{
+		return std::vector<std::uint64_t>();
+	}
+
+	/** \brief Pads the stream with zeroes up to position.
+	*/
+	inline void pad(std::ostream& os, std::uint64_t& written, std::uint64_t position)
+	{
+		static const char zeroes[graph_file_alignment] = {};
+
+		os.write(zeroes, position - written);
+		written = position;
+	}
+
+	/** \brief Checks that count values of size bytes fit between a
+	*		   section's offset and limit.
+	*/
+	inline bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t size, std::uint64_t limit)
+	{
+		return offset <= limit && count <= (limit - offset) / size;
+	}
+	/** \brief Checks that a section's length fits between its offset and
+	*		   limit, and matches its count if its values are raw.
+	*/
+	inline bool fits_section(std::uint64_t offset, std::uint64_t length, std::uint64_t count, std::uint64_t size, std::uint64_t limit)
+	{
+		if (size == 0)
+			return fits(offset, length, 1, limit);
+
+		return fits(offset, count, size, limit) && length == count * size;
+	}
+
+	/** \brief Skips the stream forward to position.
+	*/
+	inline void skip(std::istream& is, std::uint64_t& read, std::uint64_t position)
+	{
+		if (position < read)
+			throw std::runtime_error("load_graph: overlapping sections");
+
+		is.ignore(position - read);
+		read = position;
+	}
+}
+
+/** \brief Writes a graph to a stream in the serialized graph format.
+*	\param graph is the graph to write.
+*	\param os is the binary stream to write to.
+*
+*	See graph_file_header for a description of the format. Vertices
+*	are written in the graph's iteration order. Keys, vertex data and
+*	edge data are written as raw arrays when their types are trivially
+*	copyable and through serializer otherwise. A std::runtime_error is
+*	thrown if the stream fails. A graph of any policy may be written;
+*	the file records whether it is directed, and only a graph of the
+*	same directedness reads it back.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+void save_graph(const dynamic_sparse_graph<K, H, V, E, P>& graph, std::ostream& os)
+{
+	static_assert(!serialization_detail::holds_address<K>::value && !serialization_detail::holds_address<V>::value
+		&& !serialization_detail::holds_address<E>::value, "save_graph: keys and data cannot be pointers or views");
+
+	compact_graph<K, V, E, P> compact = make_compact_graph(graph);
+
+	std::uint64_t vertex_count = compact.get_size();
+	std::uint64_t entry_count = compact.targets.size();
+
+	// Number the edges in the order they are met from their vertices[0];
+	// an undirected self loop is met twice there.
+	std::unordered_map<const edge<V, E, P>*, std::uint64_t> edge_indices;
+	edge_indices.reserve(P::directed ? entry_count : entry_count / 2);
+
+	std::vector<const K*> keys(vertex_count);
+	std::vector<const V*> vertex_data(vertex_count);
+	std::vector<const E*> edge_data;
+	edge_data.reserve(P::directed ? entry_count : entry_count / 2);
+
+	for (std::uint64_t id = 0; id < vertex_count; ++id)
+	{
+		keys[id] = &compact.keys[id];
+		vertex_data[id] = &compact.vertices[id]->data;
+
+		for (std::uint64_t position = compact.offsets[id]; position < compact.offsets[id + 1]; ++position)
+		{
+			if (compact.edges[position]->vertices[0] == compact.vertices[id]
+				&& edge_indices.insert(std::make_pair(compact.edges[position], edge_data.size())).second)
+			{
+				edge_data.push_back(&compact.edges[position]->data);
+			}
+		}
+	}
+
+	std::vector<std::uint64_t> offsets(compact.offsets.begin(), compact.offsets.end());
+	std::vector<std::uint64_t> targets(compact.targets.begin(), compact.targets.end());
+	std::vector<std::uint64_t> edge_ids(entry_count);
+
+	for (std::uint64_t id = 0; id < vertex_count; ++id)
+	{
+		for (std::uint64_t position = compact.offsets[id]; position < compact.offsets[id + 1]; ++position)
+		{
+			const edge<V, E, P>* entry_edge = compact.edges[position];
+
+			edge_ids[position] = edge_indices.find(entry_edge)->second << 1 | (entry_edge->vertices[0] != compact.vertices[id]);
+		}
+	}
+
+	std::string key_bytes = serialization_detail::encode(keys, typename std::is_trivially_copyable<K>::type());
+	std::string vertex_bytes = serialization_detail::encode(vertex_data, typename std::is_trivially_copyable<V>::type());
+	std::string edge_bytes = serialization_detail::encode(edge_data, typename std::is_trivially_copyable<E>::type());
+	std::vector<std::uint64_t> index = serialization_detail::make_index<K, H>(keys, typename std::is_trivially_copyable<K>::type());
+
+	graph_file_header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DSGRAPH", 8);
+	header.version = graph_file_version;
+	header.byte_order = graph_file_byte_order;
+	header.flags = (std::is_trivially_copyable<K>::value ? raw_keys : 0)
+		| (std::is_trivially_copyable<V>::value ? raw_vertex_data : 0)
+		| (std::is_trivially_copyable<E>::value ? raw_edge_data : 0)
+		| (P::directed ? directed_edges : 0);
+	header.vertex_count = vertex_count;
+	header.edge_count = edge_data.size();
+	header.key_size = std::is_trivially_copyable<K>::value ? sizeof(K) : 0;
+	header.vertex_data_size = std::is_trivially_copyable<V>::value ? sizeof(V) : 0;
+	header.edge_data_size = std::is_trivially_copyable<E>::value ? sizeof(E) : 0;
+	header.keys_offset = serialization_detail::align(sizeof(header));
+	header.keys_length = key_bytes.size();
+	header.vertex_data_offset = serialization_detail::align(header.keys_offset + header.keys_length);
+	header.vertex_data_length = vertex_bytes.size();
+	header.offsets_offset = serialization_detail::align(header.vertex_data_offset + header.vertex_data_length);
+	header.targets_offset = serialization_detail::align(header.offsets_offset + (vertex_count + 1) * sizeof(std::uint64_t));
+	header.edge_ids_offset = serialization_detail::align(header.targets_offset + entry_count * sizeof(std::uint64_t));
+	header.edge_data_offset = serialization_detail::align(header.edge_ids_offset + entry_count * sizeof(std::uint64_t));
+	header.edge_data_length = edge_bytes.size();
+	header.index_offset = serialization_detail::align(header.edge_data_offset + header.edge_data_length);
+	header.index_capacity = index.size();
+
+	std::uint64_t written = sizeof(header);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	serialization_detail::pad(os, written, header.keys_offset);
+	os.write(key_bytes.data(), key_bytes.size());
+	written += key_bytes.size();
+
+	serialization_detail::pad(os, written, header.vertex_data_offset);
+	os.write(vertex_bytes.data(), vertex_bytes.size());
+	written += vertex_bytes.size();
+
+	serialization_detail::pad(os, written, header.offsets_offset);
+	serialization_detail::write_array(os, offsets);
+	written += offsets.size() * sizeof(std::uint64_t);
+
+	serialization_detail::pad(os, written, header.targets_offset);
+	serialization_detail::write_array(os, targets);
+	written += targets.size() * sizeof(std::uint64_t);
+
+	serialization_detail::pad(os, written, header.edge_ids_offset);
+	serialization_detail::write_array(os, edge_ids);
+	written += edge_ids.size() * sizeof(std::uint64_t);
+
+	serialization_detail::pad(os, written, header.edge_data_offset);
+	os.write(edge_bytes.data(), edge_bytes.size());
+	written += edge_bytes.size();
+
+	serialization_detail::pad(os, written, header.index_offset);
+	serialization_detail::write_array(os, index);
+
+	if (!os)
+		throw std::runtime_error("save_graph: write failed");
+}
+
+/** \brief Writes a graph to a file in the serialized graph format.
+*	\param graph is the graph to write.
+*	\param path is the path of the file, which is overwritten.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+void save_graph(const dynamic_sparse_graph<K, H, V, E, P>& graph, const std::string& path)
+{
+	std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+	if (!os)
+		throw std::runtime_error("save_graph: cannot open " + path);
+
+	save_graph(graph, os);
+}
+
+/** \brief Reads a graph from a stream in the serialized graph format.
+*	\param graph is the graph to add the vertices and edges to; it is
+*		   expected to be empty.
+*	\param is is the binary stream to read from.
+*
+*	The sections are read in bulk, the graph's buckets are reserved, and
+*	the edges are then created straight from the vertex ids with
+*	add_edges, without any key lookups: in a multigraph they are built
+*	in one block and each adjacency list grows once, so loading takes
+*	time proportional to the size of the file.
+*	A std::runtime_error is thrown if the stream is not a serialized
+*	graph of matching types, ends early or is corrupt: every count and
+*	offset is checked against the sections, and the sections against
+*	the length of the stream when it can be found, before anything is
+*	allocated from them, and the adjacency is checked before the graph
+*	is changed. A key which is already in the graph, or appears twice,
+*	is only found while the vertices are added; the graph then holds
+*	the vertices added before it.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+void load_graph(dynamic_sparse_graph<K, H, V, E, P>& graph, std::istream& is)
+{
+	static_assert(!serialization_detail::holds_address<K>::value && !serialization_detail::holds_address<V>::value
+		&& !serialization_detail::holds_address<E>::value, "load_graph: keys and data cannot be pointers or views");
+
+	graph_file_header header;
+	is.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!is || std::memcmp(header.magic, "DSGRAPH", 8) != 0)
+		throw std::runtime_error("load_graph: not a serialized graph");
+	if (header.byte_order != graph_file_byte_order)
+		throw std::runtime_error("load_graph: byte order mismatch");
+	// Version 1 lacks only the key index, which loading does not need.
+	if (header.version != 1 && header.version != graph_file_version)
+		throw std::runtime_error("load_graph: unsupported version");
+
+	std::uint32_t flags = (std::is_trivially_copyable<K>::value ? raw_keys : 0)
+		| (std::is_trivially_copyable<V>::value ? raw_vertex_data : 0)
+		| (std::is_trivially_copyable<E>::value ? raw_edge_data : 0)
+		| (P::directed ? directed_edges : 0);
+
+	if (header.flags != flags
+		|| header.key_size != (std::is_trivially_copyable<K>::value ? sizeof(K) : 0)
+		|| header.vertex_data_size != (std::is_trivially_copyable<V>::value ? sizeof(V) : 0)
+		|| header.edge_data_size != (std::is_trivially_copyable<E>::value ? sizeof(E) : 0))
+	{
+		throw std::runtime_error("load_graph: type mismatch");
+	}
+
+	std::uint64_t vertex_count = header.vertex_count;
+	std::uint64_t read = sizeof(header);
+
+	// Bound the last section by the rest of the stream, if it can be measured.
+	std::uint64_t available = ~std::uint64_t(0);
+	std::istream::pos_type here = is.tellg();
+	if (here != std::istream::pos_type(-1))
+	{
+		is.seekg(0, std::ios::end);
+		std::istream::pos_type last = is.tellg();
+		is.seekg(here);
+
+		if (last != std::istream::pos_type(-1) && last >= here)
+			available = std::uint64_t(last - here) + read;
+	}
+
+	const std::uint64_t id_size = sizeof(std::uint64_t);
+	// The number of entries which list each edge.
+	const std::uint64_t edge_entry_count = P::directed ? 1 : 2;
+
+	if (vertex_count >= ~std::uint64_t(0) / id_size || header.edge_count > ~std::uint64_t(0) / (2 * id_size)
+		|| !serialization_detail::fits_section(header.keys_offset, header.keys_length, vertex_count, header.key_size, header.vertex_data_offset)
+		|| !serialization_detail::fits_section(header.vertex_data_offset, header.vertex_data_length, vertex_count, header.vertex_data_size, header.offsets_offset)
+		|| !serialization_detail::fits(header.offsets_offset, vertex_count + 1, id_size, header.targets_offset)
+		|| !serialization_detail::fits(header.targets_offset, edge_entry_count * header.edge_count, id_size, header.edge_ids_offset)
+		|| !serialization_detail::fits(header.edge_ids_offset, edge_entry_count * header.edge_count, id_size, header.edge_data_offset)
+		|| !serialization_detail::fits_section(header.edge_data_offset, header.edge_data_length, header.edge_count, header.edge_data_size, available))
+	{
+		throw std::runtime_error("load_graph: corrupt header");
+	}
+
+	std::uint64_t entry_count = edge_entry_count * header.edge_count;
+
+	serialization_detail::skip(is, read, header.keys_offset);
+	std::vector<K> keys = serialization_detail::decode<K>(is, vertex_count, header.keys_length, typename std::is_trivially_copyable<K>::type());
+	read += header.keys_length;
+
+	serialization_detail::skip(is, read, header.vertex_data_offset);
+	std::vector<V> vertex_data = serialization_detail::decode<V>(is, vertex_count, header.vertex_data_length, typename std::is_trivially_copyable<V>::type());
+	read += header.vertex_data_length;
+
+	std::vector<std::uint64_t> offsets;
+	serialization_detail::skip(is, read, header.offsets_offset);
+	serialization_detail::read_array(is, offsets, vertex_count + 1);
+	read += offsets.size() * sizeof(std::uint64_t);
+
+	std::vector<std::uint64_t> targets;
+	serialization_detail::skip(is, read, header.targets_offset);
+	serialization_detail::read_array(is, targets, entry_count);
+	read += targets.size() * sizeof(std::uint64_t);
+
+	std::vector<std::uint64_t> edge_ids;
+	serialization_detail::skip(is, read, header.edge_ids_offset);
+	serialization_detail::read_array(is, edge_ids, entry_count);
+	read += edge_ids.size() * sizeof(std::uint64_t);
+
+	serialization_detail::skip(is, read, header.edge_data_offset);
+	std::vector<E> edge_data = serialization_detail::decode<E>(is, header.edge_count, header.edge_data_length, typename std::is_trivially_copyable<E>::type());
+
+	if (!is)
+		throw std::runtime_error("load_graph: unexpected end of stream");
+
+	if (offsets[0] != 0 || offsets[vertex_count] != entry_count)
+		throw std::runtime_error("load_graph: corrupt adjacency");
+	for (std::uint64_t id = 0; id < vertex_count; ++id)
+	{
+		if (offsets[id + 1] < offsets[id])
+			throw std::runtime_error("load_graph: corrupt adjacency");
+	}
+
+	// Recover the ends of each edge from its entries, and check that they
+	// agree, before the graph is touched.
+	std::vector<std::array<size_t, 2> > ends(header.edge_count);
+	std::vector<unsigned char> entry_counts(header.edge_count, 0);
+
+	for (std::uint64_t id = 0; id < vertex_count; ++id)
+	{
+		for (std::uint64_t position = offsets[id]; position < offsets[id + 1]; ++position)
+		{
+			std::uint64_t index = edge_ids[position] >> 1;
+
+			if (targets[position] >= vertex_count || (!P::self_loops && targets[position] == id) || index >= header.edge_count)
+				throw std::runtime_error("load_graph: corrupt adjacency");
+
+			std::array<size_t, 2> entry_ends = { size_t(id), size_t(targets[position]) };
+			if (edge_ids[position] & 1)
+				std::swap(entry_ends[0], entry_ends[1]);
+
+			if (entry_counts[index] == 0)
+				ends[index] = entry_ends;
+			else if (entry_counts[index] >= edge_entry_count || ends[index] != entry_ends)
+				throw std::runtime_error("load_graph: corrupt adjacency");
+
+			++entry_counts[index];
+		}
+	}
+
+	// Each edge is listed by both of its vertices, or by its origin if
+	// the graph is directed.
+	for (std::uint64_t index = 0; index < header.edge_count; ++index)
+	{
+		if (entry_counts[index] != edge_entry_count)
+			throw std::runtime_error("load_graph: corrupt adjacency");
+	}
+
+	std::vector<vertex<V, E, P>*> vertices(vertex_count);
+
+	graph.reserve(graph.get_size() + vertex_count);
+	for (std::uint64_t id = 0; id < vertex_count; ++id)
+	{
+		if (graph.find_vertex(keys[id]) != nullptr)
+			throw std::runtime_error("load_graph: duplicate key");
+
+		vertices[id] = &graph.add_vertex(keys[id], vertex_data[id]);
+	}
+
+	graph.add_edges(vertices, ends, edge_data);
+}
+
+/** \brief Reads a graph from a file in the serialized graph format.
+*	\param graph is the graph to add the vertices and edges to; it is
+*		   expected to be empty.
+*	\param path is the path of the file.
+*/
+template <typename K, typename H, typename V, typename E, typename P>
+void load_graph(dynamic_sparse_graph<K, H, V, E, P>& graph, const std::string& path)
+{
+	std::ifstream is(path.c_str(), std::ios::binary);
+	if (!is)
+		throw std::runtime_error("load_graph: cannot open " + path);
+
+	load_graph(graph, is);
+}
+
+#endif // SERIALIZATION_H
@@ -0,0 +1,296 @@
+
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <new>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+/** \brief A vector which keeps its first elements inside itself.
+*	\tparam T is the type of element.
+*	\tparam C is the number of elements held inline.
+*
+*	Up to C elements are stored in a buffer within the object, so a
+*	small_vector that never grows beyond C never allocates. Past that the
+*	elements move to the heap and growth is geometric, as with
+*	std::vector. Iterators are pointers and are invalidated by any
+*	change of capacity, including a move of the small_vector itself.\n
+*	Sizes are 32 bits wide to keep the object small, which limits a
+*	small_vector to 2^32 - 1 elements.
+*/
+template <typename T, size_t C>
+class small_vector
+{
+	static_assert(C > 0, "small_vector needs an inline capacity; use std::vector otherwise");
+
+public:
+	typedef T value_type;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef T* iterator;
+	typedef const T* const_iterator;
+	typedef size_t size_type;
+
+	/** \brief The default constructor.
+	*
+	*	The small_vector starts empty, using its inline buffer.
+	*/
+	small_vector()
+	: first(inline_data()), count(0), reserved(C)
+	{
+
+	}
+	/** \brief The copy constructor.
+	*	\param rhs is the small_vector to copy.
+	*/
+	small_vector(const small_vector& rhs)
+	: small_vector()
+	{
+		reserve(rhs.count);
+		std::uninitialized_copy(rhs.begin(), rhs.end(), first);
+		count = rhs.count;
+	}
+	/** \brief The move constructor.
+	*	\param rhs is the small_vector to move; it is left empty.
+	*
+	*	A heap buffer is taken over; inline elements are moved one by one.
+	*/
+	small_vector(small_vector&& rhs)
+	: small_vector()
+	{
+		steal(rhs);
+	}
+	/** \brief The destructor.
+	*/
+	~small_vector()
+	{
+		clear();
+		release();
+	}
+
+	/** \brief The assignment operator.
+	*	\param rhs is the small_vector to copy.
+	*	\return this small_vector post-assignment.
+	*/
+	small_vector& operator=(const small_vector& rhs)
+	{
+		if (this != &rhs)
+		{
+			clear();
+			reserve(rhs.count);
+			std::uninitialized_copy(rhs.begin(), rhs.end(), first);
+			count = rhs.count;
+		}
+
+		return *this;
+	}
+	/** \brief The move assignment operator.
+	*	\param rhs is the small_vector to move; it is left empty.
+	*	\return this small_vector post-assignment.
+	*/
+	small_vector& operator=(small_vector&& rhs)
+	{
+		if (this != &rhs)
+		{
+			clear();
+			release();
+			first = inline_data();
+			reserved = C;
+			steal(rhs);
+		}
+
+		return *this;
+	}
+
+	iterator begin() { return first; }
+	const_iterator begin() const { return first; }
+	iterator end() { return first + count; }
+	const_iterator end() const { return first + count; }
+	T* data() { return first; }
+	const T* data() const { return first; }
+
+	T& operator[](size_t index) { return first[index]; }
+	const T& operator[](size_t index) const { return first[index]; }
+	T& front() { return first[0]; }
+	const T& front() const { return first[0]; }
+	T& back() { return first[count - 1]; }
+	const T& back() const { return first[count - 1]; }
+
+	/** \brief Retrieve the number of elements.
+	*	\return the number of elements.
+	*/
+	size_t size() const
+	{
+		return count;
+	}
+	/** \brief Checks whether there are no elements.
+	*	\return true if there are no elements.
+	*/
+	bool empty() const
+	{
+		return count == 0;
+	}
+	/** \brief Retrieve the number of elements which fit without growing.
+	*	\return the capacity.
+	*/
+	size_t capacity() const
+	{
+		return reserved;
+	}
+	/** \brief Checks whether the elements are in the inline buffer.
+	*	\return true if no heap memory is in use.
+	*/
+	bool is_inline() const
+	{
+		return first == inline_data();
+	}
+
+	/** \brief Appends an element.
+	*	\param value is the element to append.
+	*/
+	void push_back(const T& value)
+	{
+		if (count == reserved)
+		{
+			// The value may live in this vector, so copy it before growing.
+			T copy(value);
+			grow(2 * size_t(reserved));
+			::new (static_cast<void*>(first + count)) T(std::move(copy));
+		}
+		else
+		{
+			::new (static_cast<void*>(first + count)) T(value);
+		}
+
+		++count;
+	}
+	/** \brief Removes the last element.
+	*
+	*	This function asserts that there is an element.
+	*/
+	void pop_back()
+	{
+		assert(count > 0);
+
+		first[--count].~T();
+	}
+	/** \brief Removes every element; the capacity is kept.
+	*/
+	void clear()
+	{
+		for (size_t i = 0; i < count; ++i)
+			first[i].~T();
+
+		count = 0;
+	}
+	/** \brief Makes room for a number of elements.
+	*	\param new_capacity is the number of elements to make room for.
+	*/
+	void reserve(size_t new_capacity)
+	{
+		if (new_capacity > reserved)
+			grow(new_capacity);
+	}
+	/** \brief Gives back unused heap memory, moving the elements back
+	*		   inline if they fit.
+	*/
+	void shrink_to_fit()
+	{
+		if (is_inline() || count == reserved)
+			return;
+
+		relocate(count <= C ? inline_data() : allocate(count), std::max<size_t>(count, C));
+	}
+
+private:
+	/** \brief Storage for one element.
+	*/
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+	T* inline_data()
+	{
+		return reinterpret_cast<T*>(buffer);
+	}
+	const T* inline_data() const
+	{
+		return reinterpret_cast<const T*>(buffer);
+	}
+	static T* allocate(size_t capacity)
+	{
+		return static_cast<T*>(::operator new(capacity * sizeof(T)));
+	}
+	/** \brief Give back the heap buffer, if any.
+	*/
+	void release()
+	{
+		if (!is_inline())
+			::operator delete(first);
+	}
+	/** \brief Move the elements to a new heap buffer.
+	*/
+	void grow(size_t new_capacity)
+	{
+		assert(new_capacity <= UINT32_MAX);
+
+		relocate(allocate(new_capacity), new_capacity);
+	}
+	/** \brief Move the elements to another buffer of a given capacity.
+	*/
+	void relocate(T* destination, size_t new_capacity)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			::new (static_cast<void*>(destination + i)) T(std::move(first[i]));
+			first[i].~T();
+		}
+
+		release();
+		first = destination;
+		reserved = std::uint32_t(new_capacity);
+	}
+	/** \brief Take the elements of another small_vector, which is left
+	*		   empty; this one must be empty and inline.
+	*/
+	void steal(small_vector& rhs)
+	{
+		if (rhs.is_inline())
+		{
+			for (size_t i = 0; i < rhs.count; ++i)
+				::new (static_cast<void*>(first + i)) T(std::move(rhs.first[i]));
+
+			count = rhs.count;
+			rhs.clear();
+		}
+		else
+		{
+			first = rhs.first;
+			count = rhs.count;
+			reserved = rhs.reserved;
+
+			rhs.first = rhs.inline_data();
+			rhs.count = 0;
+			rhs.reserved = C;
+		}
+	}
+
+	/** \brief The first element, inline or on the heap.
+	*/
+	T* first;
+	/** \brief The number of elements.
+	*/
+	std::uint32_t count;
+	/** \brief The number of elements which fit in the current buffer.
+	*/
+	std::uint32_t reserved;
+	/** \brief The inline buffer.
+	*/
+	storage buffer[C];
+};
+
+#endif // SMALL_VECTOR_H
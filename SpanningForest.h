@@ -0,0 +1,289 @@
+
+
+#ifndef SPANNING_FOREST_H
+#define SPANNING_FOREST_H
+
+#include "Graph.h"
+#include "CompactGraph.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <functional>
+#include <utility>
+#include <limits>
+#include <type_traits>
+
+/** \brief A disjoint-set forest over the ids 0 to size - 1.
+*
+*	Sets are merged by rank and paths are halved during lookups, so
+*	a sequence of operations runs in near-linear time.
+*/
+struct disjoint_set_forest
+{
+	/** \brief The disjoint_set_forest constructor.
+	*	\param size is the number of ids, each starting in its own set.
+	*/
+	disjoint_set_forest(size_t size)
+	: parents(size), ranks(size, 0)
+	{
+		for (size_t id = 0; id < size; ++id)
+			parents[id] = id;
+	}
+
+	/** \brief Retrieve the representative of the set containing an id.
+	*	\param id is the id to look up.
+	*	\return the representative of the set containing id.
+	*/
+	size_t find(size_t id)
+	{
+		while (parents[id] != id)
+		{
+			parents[id] = parents[parents[id]];
+			id = parents[id];
+		}
+
+		return id;
+	}
+	/** \brief Merge the sets containing two ids.
+	*	\param id_1 is an id of the first set.
+	*	\param id_2 is an id of the second set.
+	*	\return false if the ids were already in the same set.
+	*/
+	bool merge(size_t id_1, size_t id_2)
+	{
+		id_1 = find(id_1);
+		id_2 = find(id_2);
+
+		if (id_1 == id_2)
+			return false;
+
+		if (ranks[id_1] < ranks[id_2])
+			std::swap(id_1, id_2);
+
+		parents[id_2] = id_1;
+		if (ranks[id_1] == ranks[id_2])
+			++ranks[id_1];
+
+		return true;
+	}
+
+	/** \brief The parent of each id; representatives are their own parents.
+	*/
+	std::vector<size_t> parents;
+	/** \brief An upper bound on the height of each representative's tree.
+	*/
+	std::vector<unsigned char> ranks;
+};
+
+/** \brief Compute a minimum spanning forest with Kruskal's algorithm.
+*	\param compact is a snapshot of the graph.
+*	\param weight is called as weight(edge_data) and returns a value
+*		   ordered by operator<.
+*	\param thread_count is the number of threads used to sort the
+*		   edges; 0 selects default_thread_count().
+*	\return the edges of the forest.
+*
+*	Each edge is collected once (from the endpoint with the lower dense
+*	id), the edges are sorted by weight in parallel, and a disjoint-set
+*	forest rejects the edges that would close a cycle. Ties are broken
+*	by edge address, so the result is deterministic for a given graph.
+*/
+template <typename K, typename V, typename E, typename P, typename W>
+std::vector<edge<V, E, P>*> kruskal_minimum_spanning_forest(const compact_graph<K, V, E, P>& compact, W weight, size_t thread_count = 0)
+{
+	static_assert(!P::directed, "kruskal_minimum_spanning_forest: the graph must be undirected");
+
+	typedef typename std::decay<decltype(weight(std::declval<const E&>()))>::type weight_type;
+
+	struct weighted_edge
+	{
+		weight_type weight;
+		edge<V, E, P>* address;
+		size_t source;
+		size_t target;
+	};
+
+	std::vector<weighted_edge> weighted_edges;
+	weighted_edges.reserve(compact.targets.size() / 2);
+
+	for (size_t source = 0; source < compact.get_size(); ++source)
+	{
+		for (size_t position = compact.offsets[source]; position < compact.offsets[source + 1]; ++position)
+		{
+			if (source < compact.targets[position])
+			{
+				weighted_edge new_edge = { weight(compact.edges[position]->data), compact.edges[position], source, compact.targets[position] };
+				weighted_edges.push_back(new_edge);
+			}
+		}
+	}
+
+	parallel_sort(weighted_edges.begin(), weighted_edges.end(), [](const weighted_edge& lhs, const weighted_edge& rhs)
+	{
+		if (lhs.weight < rhs.weight)
+			return true;
+		if (rhs.weight < lhs.weight)
+			return false;
+		return std::less<edge<V, E, P>*>()(lhs.address, rhs.address);
+	}, thread_count);
+
+	std::vector<edge<V, E, P>*> forest;
+	disjoint_set_forest components(compact.get_size());
+
+	for (auto& weighted : weighted_edges)
+	{
+		if (components.merge(weighted.source, weighted.target))
+		{
+			forest.push_back(weighted.address);
+
+			if (forest.size() + 1 == compact.get_size())
+				break;
+		}
+	}
+
+	return forest;
+}
+
+/** \brief Compute a minimum spanning forest with Borůvka's algorithm.
+*	\param compact is a snapshot of the graph.
+*	\param weight is called as weight(edge_data) and returns a value
+*		   ordered by operator<.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the edges of the forest.
+*
+*	Each round, every vertex finds its lightest edge leaving its
+*	component in parallel; the lightest of these per component are then
+*	added to the forest and the components merged. The number of
+*	components at least halves per round, so there are at most
+*	log2(get_size()) rounds. Ties are broken by edge address, which
+*	guarantees that no round closes a cycle.
+*/
+template <typename K, typename V, typename E, typename P, typename W>
+std::vector<edge<V, E, P>*> boruvka_minimum_spanning_forest(const compact_graph<K, V, E, P>& compact, W weight, size_t thread_count = 0)
+{
+	static_assert(!P::directed, "boruvka_minimum_spanning_forest: the graph must be undirected");
+
+	typedef typename std::decay<decltype(weight(std::declval<const E&>()))>::type weight_type;
+
+	const size_t none = std::numeric_limits<size_t>::max();
+
+	size_t vertex_count = compact.get_size();
+
+	// Evaluate the weights once; each edge appears at both of its endpoints.
+	std::vector<weight_type> weights(compact.targets.size());
+	parallel_for(0, compact.targets.size(), [&](size_t first, size_t last, size_t)
+	{
+		for (size_t position = first; position < last; ++position)
+			weights[position] = weight(compact.edges[position]->data);
+	}, thread_count);
+
+	auto lighter = [&](size_t lhs, size_t rhs)
+	{
+		if (weights[lhs] < weights[rhs])
+			return true;
+		if (weights[rhs] < weights[lhs])
+			return false;
+		return std::less<edge<V, E, P>*>()(compact.edges[lhs], compact.edges[rhs]);
+	};
+
+	std::vector<edge<V, E, P>*> forest;
+	disjoint_set_forest components(vertex_count);
+
+	// component[i] is the representative of vertex i at the start of a round.
+	std::vector<size_t> component(vertex_count);
+	std::vector<size_t> lightest_by_vertex(vertex_count);
+	std::vector<size_t> lightest_by_component(vertex_count, none);
+
+	for (size_t id = 0; id < vertex_count; ++id)
+		component[id] = id;
+
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+
+		parallel_for(0, vertex_count, [&](size_t first, size_t last, size_t)
+		{
+			for (size_t id = first; id < last; ++id)
+			{
+				size_t lightest = none;
+
+				for (size_t position = compact.offsets[id]; position < compact.offsets[id + 1]; ++position)
+				{
+					if (component[compact.targets[position]] != component[id]
+						&& (lightest == none || lighter(position, lightest)))
+					{
+						lightest = position;
+					}
+				}
+
+				lightest_by_vertex[id] = lightest;
+			}
+		}, thread_count);
+
+		for (size_t id = 0; id < vertex_count; ++id)
+		{
+			size_t lightest = lightest_by_vertex[id];
+			size_t& best = lightest_by_component[component[id]];
+
+			if (lightest != none && (best == none || lighter(lightest, best)))
+				best = lightest;
+		}
+
+		for (size_t id = 0; id < vertex_count; ++id)
+		{
+			size_t& best = lightest_by_component[id];
+
+			if (best == none)
+				continue;
+
+			// Two components may have chosen the same edge.
+			if (components.merge(id, compact.targets[best]))
+			{
+				forest.push_back(compact.edges[best]);
+				merged = true;
+			}
+
+			best = none;
+		}
+
+		for (size_t id = 0; id < vertex_count; ++id)
+			component[id] = components.find(id);
+	}
+
+	return forest;
+}
+
+/** \brief Compute a minimum spanning forest of a graph.
+*	\param graph is the graph to span.
+*	\param weight is called as weight(edge_data) and returns a value
+*		   ordered by operator<.
+*	\param thread_count is the number of threads to use; 0 selects
+*		   default_thread_count().
+*	\return the edges of the forest.
+*
+*	The forest contains one spanning tree per connected component of
+*	the graph, which must be undirected; a directed graph is rejected
+*	at compile time. Large graphs are handled by the parallel Borůvka
+*	algorithm and small graphs by Kruskal's algorithm, whose sequential
+*	union-find pass is cheaper when there is little to parallelize.
+*	The returned edges are owned by the graph.
+*/
+template <typename K, typename H, typename V, typename E, typename P, typename W>
+std::vector<edge<V, E, P>*> minimum_spanning_forest(const dynamic_sparse_graph<K, H, V, E, P>& graph, W weight, size_t thread_count = 0)
+{
+	const size_t boruvka_edge_count = 1 << 16;
+
+	if (thread_count == 0)
+		thread_count = default_thread_count();
+
+	compact_graph<K, V, E, P> compact = make_compact_graph(graph, thread_count);
+
+	if (thread_count > 1 && compact.targets.size() / 2 >= boruvka_edge_count)
+		return boruvka_minimum_spanning_forest(compact, weight, thread_count);
+	else
+		return kruskal_minimum_spanning_forest(compact, weight, thread_count);
+}
+
+#endif // SPANNING_FOREST_H
@@ -0,0 +1,154 @@
+
+
+#ifndef STRING_KEYS_H
+#define STRING_KEYS_H
+
+#if __cplusplus >= 201703L
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+/** \brief A transparent hash of strings.
+*
+*	It hashes a std::string, std::string_view or C string the same way,
+*	by its characters, and declares is_transparent. As the H of a graph
+*	keyed by std::string, it lets the graph look vertices up by
+*	std::string_view or const char* without building a std::string
+*	(under C++20; see dynamic_sparse_graph::is_lookup_key).
+*/
+struct string_key_hash
+{
+	typedef void is_transparent;
+
+	size_t operator()(std::string_view key) const
+	{
+		return std::hash<std::string_view>()(key);
+	}
+	size_t operator()(const std::string& key) const
+	{
+		return std::hash<std::string_view>()(key);
+	}
+	size_t operator()(const char* key) const
+	{
+		return std::hash<std::string_view>()(key);
+	}
+};
+
+/** \brief A pool which stores each distinct string once.
+*
+*	intern copies a string into the pool the first time it is seen and
+*	returns a std::string_view of the pooled copy, which stays valid
+*	for the life of the pool. Equal strings give the same view. The
+*	copies are packed into blocks of at least block_size bytes, so
+*	interning takes an allocation per block rather than per string.\n
+*	A graph keyed by std::string_view can take its keys from a pool:
+*	the keys then cost a view each in the index, the characters of
+*	every key are stored once however many copies of it a parser
+*	reads, and looking a key up allocates nothing. The views point into
+*	the pool, so such a graph cannot be saved with save_graph or kept in
+*	a logged_graph, which reject std::string_view at compile time; copy
+*	it to a graph keyed by std::string to persist it.
+*/
+class string_pool
+{
+public:
+	/** \brief The constructor.
+	*	\param block_size is the smallest number of bytes allocated
+	*		   at a time.
+	*/
+	explicit string_pool(size_t block_size = 1 << 16)
+	: block_size(std::max(block_size, size_t(1))), block_left(0), block_next(nullptr), byte_count(0)
+	{
+
+	}
+
+	string_pool(const string_pool&) = delete;
+	string_pool& operator=(const string_pool&) = delete;
+
+	/** \brief Retrieve the pooled copy of a string, adding it if need be.
+	*	\param text is the string.
+	*	\return a view of the pooled copy, equal to text.
+	*/
+	std::string_view intern(std::string_view text)
+	{
+		auto text_it = strings.find(text);
+		if (text_it != strings.end())
+			return *text_it;
+
+		if (text.size() > block_left || block_next == nullptr)
+		{
+			size_t new_size = std::max(block_size, text.size());
+			blocks.emplace_back(new char[new_size]);
+			block_next = blocks.back().get();
+			block_left = new_size;
+			byte_count += new_size;
+		}
+
+		// An empty string is given a place too, so its view is non-null.
+		if (!text.empty())
+			std::memcpy(block_next, text.data(), text.size());
+		std::string_view pooled(block_next, text.size());
+		block_next += text.size();
+		block_left -= text.size();
+
+		strings.insert(pooled);
+
+		return pooled;
+	}
+	/** \brief Look for the pooled copy of a string.
+	*	\param text is the string.
+	*	\return a view of the pooled copy, or a null view if text has
+	*			not been interned.
+	*/
+	std::string_view find(std::string_view text) const
+	{
+		auto text_it = strings.find(text);
+
+		return text_it != strings.end() ? *text_it : std::string_view();
+	}
+	/** \brief Retrieve the number of distinct strings.
+	*	\return the number of distinct strings.
+	*/
+	size_t size() const
+	{
+		return strings.size();
+	}
+	/** \brief Estimate the memory used by the pool.
+	*	\return the bytes of the blocks and of the set of views.
+	*/
+	size_t get_memory() const
+	{
+		return byte_count + strings.bucket_count() * sizeof(void*) + strings.size() * (sizeof(void*) + sizeof(std::string_view));
+	}
+
+private:
+	/** \brief The smallest number of bytes allocated at a time.
+	*/
+	size_t block_size;
+	/** \brief The bytes left in the current block.
+	*/
+	size_t block_left;
+	/** \brief The next free byte of the current block.
+	*/
+	char* block_next;
+	/** \brief The bytes of all blocks.
+	*/
+	size_t byte_count;
+	/** \brief The blocks holding the strings.
+	*/
+	std::vector<std::unique_ptr<char[]> > blocks;
+	/** \brief The views of the pooled strings.
+	*/
+	std::unordered_set<std::string_view> strings;
+};
+
+#endif
+
+#endif // STRING_KEYS_H
@@ -0,0 +1,889 @@
+
+
+#ifndef VERSIONED_GRAPH_H
+#define VERSIONED_GRAPH_H
+
+#include "Epoch.h"
+
+#include <vector>
+#include <array>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace versioned_detail
+{
+	/** \brief The deletion time of objects which have not been deleted.
+	*/
+	const std::uint64_t never = ~std::uint64_t(0);
+
+	/** \brief A value as it was from a given time.
+	*/
+	template <typename T>
+	struct version
+	{
+		version(const T& data, std::uint64_t since, version* older)
+		: data(data), since(since), older(older)
+		{
+
+		}
+
+		T data;
+		std::uint64_t since;
+		version* older;
+	};
+
+	/** \brief The versions of a value, newest first.
+	*
+	*	Readers walk from the newest version to the first one old enough
+	*	for them; versions older than that are never read, which is what
+	*	allows trim to drop them while readers are active.
+	*/
+	template <typename T>
+	class version_chain
+	{
+	public:
+		version_chain(const T& data, std::uint64_t since)
+		: newest(new version<T>(data, since, nullptr))
+		{
+
+		}
+		~version_chain()
+		{
+			trim_after(newest.load());
+			delete newest.load();
+		}
+
+		version_chain(const version_chain&) = delete;
+		version_chain& operator=(const version_chain&) = delete;
+
+		/** \brief Retrieve the value as of a time.
+		*/
+		const T& at(std::uint64_t time) const
+		{
+			const version<T>* current = newest.load(std::memory_order_acquire);
+			while (current->since > time)
+				current = current->older;
+
+			return current->data;
+		}
+		/** \brief Add a value from a time on; writers only.
+		*/
+		void push(const T& data, std::uint64_t since)
+		{
+			newest.store(new version<T>(data, since, newest.load()), std::memory_order_release);
+		}
+		/** \brief Delete the versions no reader at or after oldest can see;
+		*		   writers only.
+		*	\return the number of versions deleted.
+		*/
+		size_t trim(std::uint64_t oldest)
+		{
+			version<T>* current = newest.load();
+			while (current->since > oldest && current->older != nullptr)
+				current = current->older;
+
+			return trim_after(current);
+		}
+
+	private:
+		static size_t trim_after(version<T>* kept)
+		{
+			size_t count = 0;
+
+			version<T>* current = kept->older;
+			kept->older = nullptr;
+
+			while (current != nullptr)
+			{
+				version<T>* older = current->older;
+				delete current;
+				current = older;
+				++count;
+			}
+
+			return count;
+		}
+
+		std::atomic<version<T>*> newest;
+	};
+
+	/** \brief An append-only array of edges read without locks.
+	*
+	*	Entries below size are immutable. The writer fills the next entry
+	*	and then publishes it by raising size; when the array is full it
+	*	publishes a larger copy instead.
+	*/
+	template <typename T>
+	struct adjacency
+	{
+		adjacency(size_t capacity)
+		: capacity(capacity), size(0), entries(new T*[capacity])
+		{
+
+		}
+
+		const size_t capacity;
+		std::atomic<size_t> size;
+		std::unique_ptr<T*[]> entries;
+	};
+}
+
+template <typename K, typename V, typename E>
+struct versioned_edge;
+
+/** \brief One lifetime of a vertex of a versioned_graph.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*
+*	A key which is removed and added again gets a new versioned_vertex,
+*	linked to the one before it through older.
+*/
+template <typename K, typename V, typename E>
+struct versioned_vertex
+{
+	/** \brief The versioned_vertex constructor.
+	*	\param key is the vertex's key.
+	*	\param data is the vertex's data.
+	*	\param created is the time of creation.
+	*	\param older is the previous lifetime of the key, if any.
+	*/
+	versioned_vertex(const K& key, const V& data, std::uint64_t created, versioned_vertex* older)
+	: key(key), data(data, created), created(created), deleted(versioned_detail::never), edges(new versioned_detail::adjacency<versioned_edge<K, V, E> >(4)), older(older)
+	{
+
+	}
+	/** \brief The destructor.
+	*
+	*	The edges themselves are owned by the graph.
+	*/
+	~versioned_vertex()
+	{
+		delete edges.load();
+	}
+
+	/** \brief Checks whether the vertex exists at a time.
+	*/
+	bool is_visible(std::uint64_t time) const
+	{
+		return created <= time && time < deleted.load(std::memory_order_acquire);
+	}
+
+	/** \brief The vertex's key.
+	*/
+	const K key;
+	/** \brief The vertex's data over time.
+	*/
+	versioned_detail::version_chain<V> data;
+	/** \brief The time at which the vertex was added.
+	*/
+	const std::uint64_t created;
+	/** \brief The time at which the vertex was removed.
+	*/
+	std::atomic<std::uint64_t> deleted;
+	/** \brief Every edge of the vertex which may still be visible.
+	*/
+	std::atomic<versioned_detail::adjacency<versioned_edge<K, V, E> >*> edges;
+	/** \brief The previous lifetime of the key.
+	*/
+	versioned_vertex* older;
+};
+
+/** \brief An edge of a versioned_graph.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*/
+template <typename K, typename V, typename E>
+struct versioned_edge
+{
+	/** \brief The versioned_edge constructor.
+	*	\param vertices are the two vertices which this edge connects.
+	*	\param data is the edge's data.
+	*	\param created is the time of creation.
+	*/
+	versioned_edge(const std::array<versioned_vertex<K, V, E>*, 2>& vertices, const E& data, std::uint64_t created)
+	: vertices(vertices), data(data, created), created(created), deleted(versioned_detail::never)
+	{
+
+	}
+
+	/** \brief Checks whether the edge exists at a time.
+	*/
+	bool is_visible(std::uint64_t time) const
+	{
+		return created <= time && time < deleted.load(std::memory_order_acquire);
+	}
+
+	/** \brief The vertices which the edge connects.
+	*/
+	const std::array<versioned_vertex<K, V, E>*, 2> vertices;
+	/** \brief The edge's data over time.
+	*/
+	versioned_detail::version_chain<E> data;
+	/** \brief The time at which the edge was added.
+	*/
+	const std::uint64_t created;
+	/** \brief The time at which the edge was removed.
+	*/
+	std::atomic<std::uint64_t> deleted;
+};
+
+/** \brief A dynamic sparse graph which keeps old versions for snapshots.
+*	\tparam K is the type of key used for accessing the vertices.
+*	\tparam H is the type of hash generated by for K.
+*	\tparam V is the type of vertex data.
+*	\tparam E is the type of edge data.
+*
+*	Every change is stamped with the next value of a logical clock, and
+*	vertices, edges and their data record when they were created and
+*	deleted instead of being freed at once. A snapshot is no more than a
+*	time: it sees exactly the objects alive at that time, costs O(1) to
+*	take however large the graph, and stays consistent while the graph
+*	goes on changing underneath it.\n
+*	Changes are made by one writer at a time; snapshots may be read from
+*	any number of threads meanwhile. Readers take the index mutex only
+*	for a key lookup and read adjacencies without locks. Old versions
+*	accumulate until collect() deletes those older than the oldest live
+*	snapshot.
+*/
+template <typename K, typename H, typename V, typename E>
+class versioned_graph
+{
+public:
+	/** \brief The type of key used for accessing the vertices.
+	*/
+	typedef K key_type;
+	/** \brief The type of vertex stored by the graph.
+	*/
+	typedef versioned_vertex<K, V, E> vertex_type;
+	/** \brief The type of edge stored by the graph.
+	*/
+	typedef versioned_edge<K, V, E> edge_type;
+
+	/** \brief A consistent view of the graph at one time.
+	*
+	*	The view pins its version: nothing visible to it is collected
+	*	while it exists, so the references it returns stay valid for its
+	*	lifetime. It must not outlive the graph.
+	*/
+	class snapshot_view
+	{
+	public:
+		/** \brief The move constructor.
+		*	\param rhs is the view to move; it is left empty.
+		*/
+		snapshot_view(snapshot_view&& rhs)
+		: graph(rhs.graph), time(rhs.time)
+		{
+			rhs.graph = nullptr;
+		}
+		/** \brief The destructor.
+		*
+		*	The version is released for collection.
+		*/
+		~snapshot_view()
+		{
+			if (graph != nullptr)
+				graph->release(time);
+		}
+
+		snapshot_view(const snapshot_view&) = delete;
+		snapshot_view& operator=(const snapshot_view&) = delete;
+
+		/** \brief Retrieve the version seen by the view.
+		*	\return the version seen by the view.
+		*/
+		std::uint64_t get_version() const
+		{
+			return time;
+		}
+		/** \brief Checks whether a vertex exists in the view.
+		*	\param key is the key of the vertex.
+		*	\return true if a vertex exists at the key.
+		*/
+		bool contains(const K& key) const
+		{
+			return graph->find(key, time) != nullptr;
+		}
+		/** \brief Retrieve the data of a vertex.
+		*	\param key is the key of the vertex.
+		*	\return the data of the vertex as of the view.
+		*
+		*	Like dynamic_sparse_graph::get_vertex, this function checks for
+		*	the existence of the vertex and throws std::out_of_range.
+		*/
+		const V& get_vertex_data(const K& key) const
+		{
+			return graph->get(key, time)->data.at(time);
+		}
+		/** \brief Retrieve the data of the edge connecting two vertices.
+		*	\param key_1 is the key corresponding to the first vertex.
+		*	\param key_2 is the key corresponding to the second vertex.
+		*	\return the data of the edge as of the view.
+		*
+		*	A std::out_of_range is thrown if there is no such edge.
+		*/
+		const E& get_edge_data(const K& key_1, const K& key_2) const
+		{
+			edge_type* found = graph->find_edge(graph->get(key_1, time), graph->get(key_2, time), time);
+			if (found == nullptr)
+				throw std::out_of_range("versioned_graph: no edge between keys");
+
+			return found->data.at(time);
+		}
+		/** \brief Checks whether two vertices are connected in the view.
+		*	\param key_1 is the key corresponding to the first vertex.
+		*	\param key_2 is the key corresponding to the second vertex.
+		*	\return true if an edge connects the vertices.
+		*/
+		bool has_edge(const K& key_1, const K& key_2) const
+		{
+			vertex_type* vertex_1 = graph->find(key_1, time);
+			vertex_type* vertex_2 = graph->find(key_2, time);
+
+			return vertex_1 != nullptr && vertex_2 != nullptr && graph->find_edge(vertex_1, vertex_2, time) != nullptr;
+		}
+		/** \brief Retrieve the number of edges of a vertex.
+		*	\param key is the key of the vertex.
+		*	\return the number of edges of the vertex in the view.
+		*/
+		size_t get_degree(const K& key) const
+		{
+			size_t degree = 0;
+			for_each_neighbor(key, [&](const K&, const E&) { ++degree; });
+
+			return degree;
+		}
+		/** \brief Calls a function on every neighbour of a vertex.
+		*	\param key is the key of the vertex.
+		*	\param function is called as function(neighbor_key, edge_data)
+		*		   for each edge of the vertex in the view.
+		*
+		*	A std::out_of_range is thrown if there is no such vertex.
+		*/
+		template <typename F>
+		void for_each_neighbor(const K& key, F function) const
+		{
+			vertex_type* key_vertex = graph->get(key, time);
+
+			epoch_guard reading(graph->domain);
+
+			const versioned_detail::adjacency<edge_type>* edges = key_vertex->edges.load(std::memory_order_acquire);
+			size_t size = edges->size.load(std::memory_order_acquire);
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				const edge_type* current = edges->entries[i];
+				if (current->is_visible(time))
+					function(current->vertices[current->vertices[0] == key_vertex]->key, current->data.at(time));
+			}
+		}
+		/** \brief Calls a function on every vertex in the view.
+		*	\param function is called as function(key, vertex_data).
+		*/
+		template <typename F>
+		void for_each_vertex(F function) const
+		{
+			for (auto current : graph->list(time))
+				function(current->key, current->data.at(time));
+		}
+
+	private:
+		friend class versioned_graph;
+
+		snapshot_view(const versioned_graph* graph, std::uint64_t time)
+		: graph(graph), time(time)
+		{
+
+		}
+
+		/** \brief The graph viewed.
+		*/
+		const versioned_graph* graph;
+		/** \brief The version seen.
+		*/
+		std::uint64_t time;
+	};
+
+	/** \brief The default constructor.
+	*/
+	versioned_graph()
+	: clock(0), vertex_count(0)
+	{
+
+	}
+	/** \brief The destructor.
+	*
+	*	Every version is deleted; no snapshot may remain.
+	*/
+	~versioned_graph()
+	{
+		std::vector<edge_type*> old_edges;
+
+		for (auto& key_chain : vertices)
+		{
+			for (vertex_type* current = key_chain.second; current != nullptr; )
+			{
+				// Each edge is gathered from its vertices[0] side.
+				versioned_detail::adjacency<edge_type>* edges = current->edges.load();
+				for (size_t i = 0; i < edges->size.load(); ++i)
+				{
+					if (edges->entries[i]->vertices[0] == current)
+						old_edges.push_back(edges->entries[i]);
+				}
+
+				vertex_type* older = current->older;
+				delete current;
+				current = older;
+			}
+		}
+
+		for (auto old_edge : old_edges)
+			delete old_edge;
+	}
+
+	versioned_graph(const versioned_graph&) = delete;
+	versioned_graph& operator=(const versioned_graph&) = delete;
+
+	/** \brief Takes a snapshot of the current version.
+	*	\return a view of the graph as it is now.
+	*/
+	snapshot_view snapshot() const
+	{
+		std::lock_guard<std::mutex> guard(snapshot_mutex);
+
+		std::uint64_t time = clock.load(std::memory_order_acquire);
+		snapshots.insert(time);
+
+		return snapshot_view(this, time);
+	}
+	/** \brief Retrieve the current version.
+	*	\return the version of the last change.
+	*/
+	std::uint64_t get_version() const
+	{
+		return clock.load(std::memory_order_acquire);
+	}
+	/** \brief Retrieve the number of vertices in the current version.
+	*	\return the number of vertices in the graph.
+	*/
+	size_t get_size() const
+	{
+		return vertex_count;
+	}
+
+	/** \brief Adds a vertex to the graph.
+	*	\param key is the key at which to store the vertex.
+	*	\param vertex_data is the data held by the vertex.
+	*	\return false if a vertex already exists at the key.
+	*/
+	bool add_vertex(const K& key, const V& vertex_data)
+	{
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		vertex_type* older = nullptr;
+
+		auto chain_it = vertices.find(key);
+		if (chain_it != vertices.end())
+		{
+			if (chain_it->second->deleted.load() == versioned_detail::never)
+				return false;
+
+			older = chain_it->second;
+		}
+
+		std::uint64_t time = clock.load() + 1;
+		vertex_type* new_vertex = new vertex_type(key, vertex_data, time, older);
+		{
+			std::lock_guard<std::mutex> index_guard(index_mutex);
+			vertices[key] = new_vertex;
+		}
+
+		++vertex_count;
+		clock.store(time, std::memory_order_release);
+
+		return true;
+	}
+	/** \brief Adds an edge to the graph.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param edge_data is the data held by the edge.
+	*	\return false if either vertex does not exist.
+	*
+	*	This function asserts that the key arguments are not equal.
+	*/
+	bool add_edge(const K& key_1, const K& key_2, const E& edge_data)
+	{
+		assert(key_1 != key_2);
+
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		vertex_type* vertex_1 = find_live(key_1);
+		vertex_type* vertex_2 = find_live(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return false;
+
+		std::uint64_t time = clock.load() + 1;
+		std::array<vertex_type*, 2> new_edge_vertices = { vertex_1, vertex_2 };
+		edge_type* new_edge = new edge_type(new_edge_vertices, edge_data, time);
+
+		append(vertex_1, new_edge);
+		append(vertex_2, new_edge);
+
+		clock.store(time, std::memory_order_release);
+
+		return true;
+	}
+	/** \brief Changes the data of a vertex.
+	*	\param key is the key of the vertex.
+	*	\param vertex_data is the new data.
+	*	\return false if there is no such vertex.
+	*
+	*	Snapshots taken earlier keep seeing the old data.
+	*/
+	bool set_vertex_data(const K& key, const V& vertex_data)
+	{
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		vertex_type* key_vertex = find_live(key);
+		if (key_vertex == nullptr)
+			return false;
+
+		std::uint64_t time = clock.load() + 1;
+		key_vertex->data.push(vertex_data, time);
+
+		clock.store(time, std::memory_order_release);
+
+		return true;
+	}
+	/** \brief Changes the data of the edge connecting two vertices.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\param edge_data is the new data.
+	*	\return false if there is no such edge.
+	*
+	*	Snapshots taken earlier keep seeing the old data.
+	*/
+	bool set_edge_data(const K& key_1, const K& key_2, const E& edge_data)
+	{
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		edge_type* key_edge = find_live_edge(key_1, key_2);
+		if (key_edge == nullptr)
+			return false;
+
+		std::uint64_t time = clock.load() + 1;
+		key_edge->data.push(edge_data, time);
+
+		clock.store(time, std::memory_order_release);
+
+		return true;
+	}
+
+	/** \brief Removes a vertex and its edges from the graph.
+	*	\param key is the key corresponding to the desired vertex.
+	*	\return false if the vertex does not exist.
+	*
+	*	Snapshots taken earlier keep seeing the vertex and its edges.
+	*/
+	bool remove_vertex(const K& key)
+	{
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		vertex_type* old_vertex = find_live(key);
+		if (old_vertex == nullptr)
+			return false;
+
+		std::uint64_t time = clock.load() + 1;
+
+		versioned_detail::adjacency<edge_type>* edges = old_vertex->edges.load();
+		for (size_t i = 0; i < edges->size.load(); ++i)
+		{
+			if (edges->entries[i]->deleted.load() == versioned_detail::never)
+				edges->entries[i]->deleted.store(time, std::memory_order_release);
+		}
+
+		old_vertex->deleted.store(time, std::memory_order_release);
+
+		--vertex_count;
+		clock.store(time, std::memory_order_release);
+
+		return true;
+	}
+	/** \brief Removes the edge connecting two vertices.
+	*	\param key_1 is the key corresponding to the first vertex.
+	*	\param key_2 is the key corresponding to the second vertex.
+	*	\return false if there is no such edge.
+	*
+	*	Snapshots taken earlier keep seeing the edge.
+	*/
+	bool remove_edge(const K& key_1, const K& key_2)
+	{
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		edge_type* old_edge = find_live_edge(key_1, key_2);
+		if (old_edge == nullptr)
+			return false;
+
+		std::uint64_t time = clock.load() + 1;
+		old_edge->deleted.store(time, std::memory_order_release);
+
+		clock.store(time, std::memory_order_release);
+
+		return true;
+	}
+
+	/** \brief Deletes the versions which no snapshot can see any more.
+	*	\return the number of vertices, edges and data versions deleted.
+	*
+	*	Everything deleted or overwritten before the oldest live snapshot
+	*	(or before now, if there is none) is reclaimed. Key lookups wait
+	*	while this runs; adjacency reads do not.
+	*/
+	size_t collect()
+	{
+		std::lock_guard<std::mutex> guard(write_mutex);
+
+		std::uint64_t oldest;
+		{
+			std::lock_guard<std::mutex> snapshot_guard(snapshot_mutex);
+			oldest = snapshots.empty() ? clock.load() : *snapshots.begin();
+		}
+
+		size_t count = 0;
+
+		epoch_guard reading(domain);
+		std::lock_guard<std::mutex> index_guard(index_mutex);
+
+		for (auto chain_it = vertices.begin(); chain_it != vertices.end(); )
+		{
+			vertex_type** link = &chain_it->second;
+			while (*link != nullptr)
+			{
+				vertex_type* current = *link;
+
+				count += current->data.trim(oldest);
+				count += compact(current, oldest);
+
+				if (current->deleted.load() <= oldest)
+				{
+					*link = current->older;
+					domain.retire(current);
+					++count;
+				}
+				else
+				{
+					link = &current->older;
+				}
+			}
+
+			if (chain_it->second == nullptr)
+				chain_it = vertices.erase(chain_it);
+			else
+				++chain_it;
+		}
+
+		return count;
+	}
+
+private:
+	/** \brief Look up the lifetime of a key alive at a time, or nullptr.
+	*/
+	vertex_type* find(const K& key, std::uint64_t time) const
+	{
+		std::lock_guard<std::mutex> guard(index_mutex);
+
+		auto chain_it = vertices.find(key);
+		if (chain_it == vertices.end())
+			return nullptr;
+
+		vertex_type* current = chain_it->second;
+		while (current != nullptr && current->created > time)
+			current = current->older;
+
+		return current != nullptr && current->is_visible(time) ? current : nullptr;
+	}
+	/** \brief Look up a vertex alive at a time, or throw std::out_of_range.
+	*/
+	vertex_type* get(const K& key, std::uint64_t time) const
+	{
+		vertex_type* found = find(key, time);
+		if (found == nullptr)
+			throw std::out_of_range("versioned_graph: no vertex at key");
+
+		return found;
+	}
+	/** \brief Look up the edge connecting two vertices at a time.
+	*/
+	edge_type* find_edge(vertex_type* vertex_1, vertex_type* vertex_2, std::uint64_t time) const
+	{
+		epoch_guard reading(domain);
+
+		const versioned_detail::adjacency<edge_type>* edges = vertex_1->edges.load(std::memory_order_acquire);
+		size_t size = edges->size.load(std::memory_order_acquire);
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			edge_type* current = edges->entries[i];
+			if (current->vertices[current->vertices[0] == vertex_1] == vertex_2 && current->is_visible(time))
+				return current;
+		}
+
+		return nullptr;
+	}
+	/** \brief List the vertices alive at a time.
+	*/
+	std::vector<vertex_type*> list(std::uint64_t time) const
+	{
+		std::vector<vertex_type*> listed;
+
+		std::lock_guard<std::mutex> guard(index_mutex);
+		listed.reserve(vertices.size());
+
+		for (auto& key_chain : vertices)
+		{
+			vertex_type* current = key_chain.second;
+			while (current != nullptr && current->created > time)
+				current = current->older;
+
+			if (current != nullptr && current->is_visible(time))
+				listed.push_back(current);
+		}
+
+		return listed;
+	}
+	/** \brief Look up the live vertex at a key; writers only.
+	*/
+	vertex_type* find_live(const K& key) const
+	{
+		auto chain_it = vertices.find(key);
+		if (chain_it == vertices.end() || chain_it->second->deleted.load() != versioned_detail::never)
+			return nullptr;
+
+		return chain_it->second;
+	}
+	/** \brief Look up the live edge connecting two keys; writers only.
+	*/
+	edge_type* find_live_edge(const K& key_1, const K& key_2) const
+	{
+		vertex_type* vertex_1 = find_live(key_1);
+		vertex_type* vertex_2 = find_live(key_2);
+
+		if (vertex_1 == nullptr || vertex_2 == nullptr)
+			return nullptr;
+
+		return find_edge(vertex_1, vertex_2, clock.load());
+	}
+	/** \brief Append an edge to a vertex's adjacency; writers only.
+	*/
+	void append(vertex_type* some_vertex, edge_type* new_edge)
+	{
+		versioned_detail::adjacency<edge_type>* edges = some_vertex->edges.load();
+		size_t size = edges->size.load();
+
+		if (size == edges->capacity)
+		{
+			versioned_detail::adjacency<edge_type>* grown = new versioned_detail::adjacency<edge_type>(2 * edges->capacity);
+			std::copy(edges->entries.get(), edges->entries.get() + size, grown->entries.get());
+			grown->size.store(size, std::memory_order_relaxed);
+
+			some_vertex->edges.store(grown, std::memory_order_release);
+			domain.retire(edges);
+			edges = grown;
+		}
+
+		edges->entries[size] = new_edge;
+		edges->size.store(size + 1, std::memory_order_release);
+	}
+	/** \brief Drop the edges which no snapshot can see from a vertex's
+	*		   adjacency and trim the data of those remaining; collect only.
+	*	\return the number of edges and data versions deleted.
+	*/
+	size_t compact(vertex_type* some_vertex, std::uint64_t oldest)
+	{
+		versioned_detail::adjacency<edge_type>* edges = some_vertex->edges.load();
+		size_t size = edges->size.load();
+		size_t count = 0;
+
+		std::vector<edge_type*> kept;
+		kept.reserve(size);
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			edge_type* current = edges->entries[i];
+			bool owned = current->vertices[0] == some_vertex;
+
+			if (current->deleted.load() <= oldest)
+			{
+				// The edge is dropped from both sides in this pass.
+				if (owned)
+				{
+					domain.retire(current);
+					++count;
+				}
+			}
+			else
+			{
+				if (owned)
+					count += current->data.trim(oldest);
+				kept.push_back(current);
+			}
+		}
+
+		if (kept.size() != size)
+		{
+			versioned_detail::adjacency<edge_type>* compacted = new versioned_detail::adjacency<edge_type>(std::max<size_t>(4, kept.size() + kept.size() / 2));
+			std::copy(kept.begin(), kept.end(), compacted->entries.get());
+			compacted->size.store(kept.size(), std::memory_order_relaxed);
+
+			some_vertex->edges.store(compacted, std::memory_order_release);
+			domain.retire(edges);
+		}
+
+		return count;
+	}
+	/** \brief Release a snapshot's version.
+	*/
+	void release(std::uint64_t time) const
+	{
+		std::lock_guard<std::mutex> guard(snapshot_mutex);
+		snapshots.erase(snapshots.find(time));
+	}
+
+	/** \brief The domain to which replaced adjacencies and collected
+	*		   objects are retired; destroyed last.
+	*/
+	mutable epoch_domain domain;
+	/** \brief The key of each vertex to its newest lifetime.
+	*/
+	std::unordered_map<K, vertex_type*, H> vertices;
+	/** \brief The version of the last change.
+	*/
+	std::atomic<std::uint64_t> clock;
+	/** \brief The number of vertices in the current version.
+	*/
+	std::atomic<size_t> vertex_count;
+	/** \brief Serializes writers and collect().
+	*/
+	std::mutex write_mutex;
+	/** \brief Guards vertices against concurrent change and lookup.
+	*/
+	mutable std::mutex index_mutex;
+	/** \brief Guards snapshots.
+	*/
+	mutable std::mutex snapshot_mutex;
+	/** \brief The versions of the live snapshots.
+	*/
+	mutable std::multiset<std::uint64_t> snapshots;
+};
+
+#endif // VERSIONED_GRAPH_H
@@ -0,0 +1,843 @@
+#ifndef VERTEX_INDEX_H
+#define VERTEX_INDEX_H
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <functional>
+#include <stdexcept>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+/*	A graph_policy chooses the map from keys to vertices with one of the
+*	selectors below. A selector provides
+*	\code
+*	template <typename K, typename T, typename H> struct rebind { typedef ... type; };
+*	\endcode
+*	where type has the part of the std::unordered_map interface used by
+*	dynamic_sparse_graph (begin, end, find, at, insert, erase, size,
+*	reserve and swap) and an overload of index_memory.
+*/
+
+namespace vertex_index_detail
+{
+	/** \brief The key equality of a hash map with hash H.
+	*
+	*	Transparent hashes get transparent equality, so that the map
+	*	finds keys of other types (C++20 heterogeneous lookup).
+	*/
+	template <typename K, typename H, typename = void>
+	struct key_equal
+	{
+		typedef std::equal_to<K> type;
+	};
+#if __cplusplus >= 202002L
+	template <typename K, typename H>
+	struct key_equal<K, H, std::void_t<typename H::is_transparent> >
+	{
+		typedef std::equal_to<> type;
+	};
+#endif
+	/** \brief Spread the bits of a hash (the finalizer of MurmurHash3).
+	*/
+	inline std::uint64_t mix(std::uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ULL;
+		return hash ^ (hash >> 33);
+	}
+}
+
+/** \brief Selects std::unordered_map as the vertex index.
+*
+*	This is the default. Growing it rehashes every key at once. With a
+*	transparent hash it also finds vertices by keys of other types.
+*/
+struct hashed_index
+{
+	template <typename K, typename T, typename H>
+	struct rebind
+	{
+		typedef std::unordered_map<K, T, H, typename vertex_index_detail::key_equal<K, H>::type> type;
+	};
+};
+
+/** \brief Estimate the memory used by a std::unordered_map index.
+*	\param index is the index to measure.
+*	\return the bytes of its buckets and nodes.
+*
+*	Each node of the index holds a next pointer beside its entry.
+*/
+template <typename K, typename T, typename H, typename Q>
+size_t index_memory(const std::unordered_map<K, T, H, Q>& index)
+{
+	return index.bucket_count() * sizeof(void*) + index.size() * (sizeof(void*) + sizeof(typename std::unordered_map<K, T, H, Q>::value_type));
+}
+
+/** \brief A hash map which grows one small shard at a time.
+*	\tparam K is the type of key.
+*	\tparam T is the type of mapped value.
+*	\tparam H is the hash of K.
+*	\tparam S is the number of entries a shard holds before it splits.
+*
+*	This is extendible hashing: a directory, indexed by the low bits of
+*	the mixed hash of a key, points to shards which are unordered_maps
+*	sized for S entries up front. A full shard splits in two on the
+*	next bit of the hash, moving about half of its entries, and the
+*	directory doubles when a shard uses as many bits as it does. No
+*	operation ever rehashes more than one shard, so an insertion costs
+*	at most O(S) besides the rare doubling of the directory, which
+*	holds one pointer per S / 2 entries or so; there is no stall or
+*	memory spike from rehashing the whole map. A shard whose split
+*	moves nothing, because more than S of its keys share their mixed
+*	hash (a weak H), is left to grow past S instead, and is only split
+*	again once it has doubled.\n
+*	Iteration visits the shards in their order of creation. Inserting
+*	may move entries to a new shard, invalidating iterators, but
+*	references to entries stay valid until they are erased.
+*/
+template <typename K, typename T, typename H = std::hash<K>, size_t S = 4096>
+class extendible_hash_map
+{
+	static_assert(S > 0, "extendible_hash_map needs a shard capacity");
+
+	/** \brief A shard, holding the keys whose hashes end in the same
+	*		   depth bits.
+	*/
+	struct shard
+	{
+		shard(unsigned depth)
+		: depth(depth), limit(S)
+		{
+			entries.reserve(S);
+		}
+
+		/** \brief The number of low hash bits its keys share.
+		*/
+		unsigned depth;
+		/** \brief The number of entries at which it splits; S unless a
+		*		   split of it moved nothing.
+		*/
+		size_t limit;
+		/** \brief The entries of the shard.
+		*/
+		std::unordered_map<K, T, H> entries;
+	};
+
+	/** \brief The iterator over the entries, const or not.
+	*/
+	template <typename Q, typename I>
+	class basic_iterator
+	{
+		friend class extendible_hash_map;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef typename std::iterator_traits<I>::value_type value_type;
+		typedef typename std::iterator_traits<I>::difference_type difference_type;
+		typedef typename std::iterator_traits<I>::reference reference;
+		typedef typename std::iterator_traits<I>::pointer pointer;
+
+		basic_iterator()
+		: shards(nullptr), shard_index(0)
+		{
+
+		}
+		/** \brief Converts an iterator to a const_iterator.
+		*/
+		template <typename R, typename J>
+		basic_iterator(const basic_iterator<R, J>& rhs)
+		: shards(rhs.shards), shard_index(rhs.shard_index), entry_it(rhs.entry_it)
+		{
+
+		}
+
+		reference operator*() const { return *entry_it; }
+		pointer operator->() const { return &*entry_it; }
+		basic_iterator& operator++()
+		{
+			++entry_it;
+			settle();
+			return *this;
+		}
+		basic_iterator operator++(int)
+		{
+			basic_iterator old = *this;
+			++*this;
+			return old;
+		}
+		bool operator==(const basic_iterator& rhs) const
+		{
+			// Default constructed iterators have no shards to look at.
+			if (shards != rhs.shards || shard_index != rhs.shard_index)
+				return false;
+
+			return shards == nullptr || shard_index == shards->size() || entry_it == rhs.entry_it;
+		}
+		bool operator!=(const basic_iterator& rhs) const
+		{
+			return !(*this == rhs);
+		}
+
+	private:
+		template <typename R, typename J>
+		friend class basic_iterator;
+
+		basic_iterator(Q* shards, size_t shard_index, I entry_it)
+		: shards(shards), shard_index(shard_index), entry_it(entry_it)
+		{
+
+		}
+
+		/** \brief Move on to the next shard while this one is done.
+		*/
+		void settle()
+		{
+			while (shard_index < shards->size() && entry_it == (*shards)[shard_index]->entries.end())
+			{
+				if (++shard_index < shards->size())
+					entry_it = (*shards)[shard_index]->entries.begin();
+			}
+		}
+
+		Q* shards;
+		size_t shard_index;
+		I entry_it;
+	};
+
+	typedef std::vector<std::unique_ptr<shard> > shard_list;
+
+public:
+	typedef K key_type;
+	typedef T mapped_type;
+	typedef std::pair<const K, T> value_type;
+	typedef basic_iterator<shard_list, typename std::unordered_map<K, T, H>::iterator> iterator;
+	typedef basic_iterator<const shard_list, typename std::unordered_map<K, T, H>::const_iterator> const_iterator;
+
+	/** \brief The default constructor.
+	*
+	*	The map starts with a single shard.
+	*/
+	extendible_hash_map()
+	: global_depth(0), entry_count(0)
+	{
+		shards.emplace_back(new shard(0));
+		directory.push_back(0);
+	}
+	/** \brief The copy constructor.
+	*	\param rhs is the map to copy.
+	*/
+	extendible_hash_map(const extendible_hash_map& rhs)
+	: extendible_hash_map()
+	{
+		insert(rhs.begin(), rhs.end());
+	}
+	/** \brief The move constructor.
+	*	\param rhs is the map to move; it is left empty.
+	*/
+	extendible_hash_map(extendible_hash_map&& rhs)
+	: extendible_hash_map()
+	{
+		swap(rhs);
+	}
+	/** \brief The assignment operator.
+	*	\param rhs is the map to be assigned.
+	*	\return this map post-assignment.
+	*/
+	extendible_hash_map& operator=(extendible_hash_map rhs)
+	{
+		swap(rhs);
+
+		return *this;
+	}
+
+	iterator begin()
+	{
+		iterator first(&shards, 0, shards[0]->entries.begin());
+		first.settle();
+		return first;
+	}
+	const_iterator begin() const
+	{
+		const_iterator first(&shards, 0, shards[0]->entries.begin());
+		first.settle();
+		return first;
+	}
+	iterator end()
+	{
+		return iterator(&shards, shards.size(), typename std::unordered_map<K, T, H>::iterator());
+	}
+	const_iterator end() const
+	{
+		return const_iterator(&shards, shards.size(), typename std::unordered_map<K, T, H>::const_iterator());
+	}
+
+	/** \brief Retrieve the number of entries.
+	*	\return the number of entries.
+	*/
+	size_t size() const
+	{
+		return entry_count;
+	}
+	/** \brief Checks whether there are no entries.
+	*	\return true if there are no entries.
+	*/
+	bool empty() const
+	{
+		return entry_count == 0;
+	}
+	/** \brief Does nothing; the map grows by shards as entries come.
+	*/
+	void reserve(size_t)
+	{
+
+	}
+
+	/** \brief Look for the entry of a key.
+	*	\param key is the key to look for.
+	*	\return an iterator to the entry, or end() if there is none.
+	*/
+	iterator find(const K& key)
+	{
+		size_t shard_index = directory[get_slot(key)];
+		auto entry_it = shards[shard_index]->entries.find(key);
+
+		return entry_it != shards[shard_index]->entries.end() ? iterator(&shards, shard_index, entry_it) : end();
+	}
+	const_iterator find(const K& key) const
+	{
+		size_t shard_index = directory[get_slot(key)];
+		auto entry_it = shards[shard_index]->entries.find(key);
+
+		return entry_it != shards[shard_index]->entries.end() ? const_iterator(&shards, shard_index, entry_it) : end();
+	}
+	/** \brief Retrieve the value mapped to a key.
+	*	\param key is the key of the entry.
+	*	\return the value mapped to the key.
+	*
+	*	This function throws std::out_of_range if there is no entry.
+	*/
+	T& at(const K& key)
+	{
+		auto& entries = shards[directory[get_slot(key)]]->entries;
+		auto entry_it = entries.find(key);
+
+		if (entry_it == entries.end())
+			throw std::out_of_range("extendible_hash_map::at: no such key");
+
+		return entry_it->second;
+	}
+	const T& at(const K& key) const
+	{
+		auto& entries = shards[directory[get_slot(key)]]->entries;
+		auto entry_it = entries.find(key);
+
+		if (entry_it == entries.end())
+			throw std::out_of_range("extendible_hash_map::at: no such key");
+
+		return entry_it->second;
+	}
+
+	/** \brief Adds an entry unless its key is present.
+	*	\param entry is the entry to add.
+	*	\return an iterator to the entry of the key, and whether it was
+	*			added.
+	*
+	*	A full shard is split first, which takes O(S) time.
+	*/
+	std::pair<iterator, bool> insert(const value_type& entry)
+	{
+		for (;;)
+		{
+			size_t slot = get_slot(entry.first);
+			size_t shard_index = directory[slot];
+			auto& entries = shards[shard_index]->entries;
+
+			if (entries.size() < shards[shard_index]->limit)
+			{
+				auto inserted = entries.insert(entry);
+				entry_count += inserted.second;
+
+				return std::make_pair(iterator(&shards, shard_index, inserted.first), inserted.second);
+			}
+
+			auto entry_it = entries.find(entry.first);
+			if (entry_it != entries.end())
+				return std::make_pair(iterator(&shards, shard_index, entry_it), false);
+
+			split(shard_index, slot);
+		}
+	}
+	/** \brief Adds a range of entries, skipping present keys.
+	*/
+	template <typename I>
+	void insert(I first, I last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+	/** \brief Removes the entry of a key.
+	*	\param key is the key of the entry.
+	*	\return the number of entries removed.
+	*
+	*	Shards are never merged back.
+	*/
+	size_t erase(const K& key)
+	{
+		size_t erased = shards[directory[get_slot(key)]]->entries.erase(key);
+		entry_count -= erased;
+
+		return erased;
+	}
+	/** \brief Swaps two maps.
+	*	\param rhs is the other map.
+	*/
+	void swap(extendible_hash_map& rhs)
+	{
+		std::swap(global_depth, rhs.global_depth);
+		std::swap(entry_count, rhs.entry_count);
+		directory.swap(rhs.directory);
+		shards.swap(rhs.shards);
+	}
+
+	/** \brief Estimate the memory used by the map.
+	*	\return the bytes of the directory, shards, buckets and nodes.
+	*/
+	size_t get_memory() const
+	{
+		size_t memory = directory.capacity() * sizeof(size_t) + shards.capacity() * sizeof(void*);
+
+		for (auto& current : shards)
+			memory += sizeof(shard) + current->entries.bucket_count() * sizeof(void*) + current->entries.size() * (sizeof(void*) + sizeof(value_type));
+
+		return memory;
+	}
+
+private:
+	/** \brief The directory slot of a key.
+	*/
+	size_t get_slot(const K& key) const
+	{
+		return size_t(vertex_index_detail::mix(std::uint64_t(H()(key)))) & (directory.size() - 1);
+	}
+	/** \brief Split a full shard in two on the next bit of the hash.
+	*	\param shard_index is the shard to split.
+	*	\param slot is a directory slot pointing to it.
+	*/
+	void split(size_t shard_index, size_t slot)
+	{
+		shard& old_shard = *shards[shard_index];
+
+		assert(old_shard.depth < 64);
+
+		if (old_shard.depth == global_depth)
+		{
+			size_t old_size = directory.size();
+			directory.resize(2 * old_size);
+			std::copy(directory.begin(), directory.begin() + old_size, directory.begin() + old_size);
+			++global_depth;
+		}
+
+		size_t bit = size_t(1) << old_shard.depth;
+		size_t new_index = shards.size();
+
+		shards.emplace_back(new shard(old_shard.depth + 1));
+		shard& new_shard = *shards.back();
+		++old_shard.depth;
+
+		for (auto entry_it = old_shard.entries.begin(); entry_it != old_shard.entries.end(); )
+		{
+			if (vertex_index_detail::mix(std::uint64_t(H()(entry_it->first))) & bit)
+			{
+#if __cplusplus >= 201703L
+				// Relink the node rather than copying the entry.
+				auto moved_it = entry_it++;
+				new_shard.entries.insert(old_shard.entries.extract(moved_it));
+#else
+				new_shard.entries.insert(*entry_it);
+				entry_it = old_shard.entries.erase(entry_it);
+#endif
+			}
+			else
+			{
+				++entry_it;
+			}
+		}
+
+		// The slots of the old shard with the bit set now go to the new one.
+		size_t low_bits = slot & (bit - 1);
+		for (size_t current = low_bits | bit; current < directory.size(); current += 2 * bit)
+			directory[current] = new_index;
+
+		// If every entry went one way, the keys may share their whole
+		// hash; let that shard double before it is split again, rather
+		// than doubling the directory on every insertion.
+		old_shard.limit = S;
+		if (new_shard.entries.empty())
+			old_shard.limit = 2 * old_shard.entries.size();
+		else if (old_shard.entries.empty())
+			new_shard.limit = 2 * new_shard.entries.size();
+	}
+
+	/** \brief The number of hash bits indexing the directory.
+	*/
+	unsigned global_depth;
+	/** \brief The number of entries.
+	*/
+	size_t entry_count;
+	/** \brief The shard of each combination of the low hash bits.
+	*/
+	std::vector<size_t> directory;
+	/** \brief The shards, in order of creation.
+	*/
+	shard_list shards;
+};
+
+/** \brief Estimate the memory used by an extendible_hash_map index.
+*/
+template <typename K, typename T, typename H, size_t S>
+size_t index_memory(const extendible_hash_map<K, T, H, S>& index)
+{
+	return index.get_memory();
+}
+
+/** \brief Selects extendible_hash_map as the vertex index.
+*	\tparam S is the number of entries a shard holds before it splits.
+*
+*	Adding a vertex then never rehashes more than S keys, which keeps
+*	its worst case latency bounded on very large graphs.
+*/
+template <size_t S = 4096>
+struct extendible_index
+{
+	template <typename K, typename T, typename H>
+	struct rebind
+	{
+		typedef extendible_hash_map<K, T, H, S> type;
+	};
+};
+
+/** \brief A map from small non-negative integers, kept as an array.
+*	\tparam K is the type of key; it must be integral.
+*	\tparam T is the type of mapped value.
+*	\tparam H is accepted for the selector interface and unused.
+*
+*	The entry of key k lives in slot k of a vector, so looking a key up
+*	is an array access, without hashing or probing. The vector grows to
+*	the largest key inserted, so this suits keys numbered densely from
+*	0, e.g. the vertex ids of most graph files; reserving the number of
+*	keys up front makes inserting them allocate once. Negative keys are
+*	rejected with std::out_of_range.\n
+*	Iteration visits the keys in increasing order, skipping empty slots.
+*	Inserting may reallocate the vector, invalidating iterators and
+*	references to entries.
+*/
+template <typename K, typename T, typename H = std::hash<K> >
+class direct_map
+{
+	static_assert(std::is_integral<K>::value, "direct_map needs integral keys");
+
+public:
+	typedef K key_type;
+	typedef T mapped_type;
+	typedef std::pair<const K, T> value_type;
+
+private:
+	typedef std::vector<value_type> slot_list;
+
+	/** \brief The iterator over the entries, const or not.
+	*/
+	template <typename M, typename Q>
+	class basic_iterator
+	{
+		friend class direct_map;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef typename std::remove_const<Q>::type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef Q& reference;
+		typedef Q* pointer;
+
+		basic_iterator()
+		: map(nullptr), slot(0)
+		{
+
+		}
+		/** \brief Converts an iterator to a const_iterator.
+		*/
+		template <typename N, typename R>
+		basic_iterator(const basic_iterator<N, R>& rhs)
+		: map(rhs.map), slot(rhs.slot)
+		{
+
+		}
+
+		reference operator*() const { return map->slots[slot]; }
+		pointer operator->() const { return &map->slots[slot]; }
+		basic_iterator& operator++()
+		{
+			++slot;
+			settle();
+			return *this;
+		}
+		basic_iterator operator++(int)
+		{
+			basic_iterator old = *this;
+			++*this;
+			return old;
+		}
+		bool operator==(const basic_iterator& rhs) const
+		{
+			return slot == rhs.slot;
+		}
+		bool operator!=(const basic_iterator& rhs) const
+		{
+			return slot != rhs.slot;
+		}
+
+	private:
+		template <typename N, typename R>
+		friend class basic_iterator;
+
+		basic_iterator(M* map, size_t slot)
+		: map(map), slot(slot)
+		{
+
+		}
+
+		/** \brief Move on to the next slot in use.
+		*/
+		void settle()
+		{
+			while (slot < map->slots.size() && !map->present[slot])
+				++slot;
+		}
+
+		M* map;
+		size_t slot;
+	};
+
+public:
+	typedef basic_iterator<direct_map, value_type> iterator;
+	typedef basic_iterator<const direct_map, const value_type> const_iterator;
+
+	/** \brief The default constructor.
+	*/
+	direct_map()
+	: entry_count(0)
+	{
+
+	}
+	/** \brief The assignment operator.
+	*	\param rhs is the map to be assigned.
+	*	\return this map post-assignment.
+	*
+	*	The keys of the slots are const, so the slots are swapped in
+	*	rather than assigned.
+	*/
+	direct_map& operator=(direct_map rhs)
+	{
+		swap(rhs);
+
+		return *this;
+	}
+
+	iterator begin()
+	{
+		iterator first(this, 0);
+		first.settle();
+		return first;
+	}
+	const_iterator begin() const
+	{
+		const_iterator first(this, 0);
+		first.settle();
+		return first;
+	}
+	iterator end()
+	{
+		return iterator(this, slots.size());
+	}
+	const_iterator end() const
+	{
+		return const_iterator(this, slots.size());
+	}
+
+	/** \brief Retrieve the number of entries.
+	*	\return the number of entries.
+	*/
+	size_t size() const
+	{
+		return entry_count;
+	}
+	/** \brief Checks whether there are no entries.
+	*	\return true if there are no entries.
+	*/
+	bool empty() const
+	{
+		return entry_count == 0;
+	}
+	/** \brief Make room for the keys below a bound.
+	*	\param key_bound is one more than the largest key expected.
+	*/
+	void reserve(size_t key_bound)
+	{
+		slots.reserve(key_bound);
+		present.reserve(key_bound);
+	}
+
+	/** \brief Look for the entry of a key.
+	*	\param key is the key to look for.
+	*	\return an iterator to the entry, or end() if there is none.
+	*/
+	iterator find(const K& key)
+	{
+		return contains(key) ? iterator(this, size_t(key)) : end();
+	}
+	const_iterator find(const K& key) const
+	{
+		return contains(key) ? const_iterator(this, size_t(key)) : end();
+	}
+	/** \brief Retrieve the value mapped to a key.
+	*	\param key is the key of the entry.
+	*	\return the value mapped to the key.
+	*
+	*	This function throws std::out_of_range if there is no entry.
+	*/
+	T& at(const K& key)
+	{
+		if (!contains(key))
+			throw std::out_of_range("direct_map::at: no such key");
+
+		return slots[size_t(key)].second;
+	}
+	const T& at(const K& key) const
+	{
+		if (!contains(key))
+			throw std::out_of_range("direct_map::at: no such key");
+
+		return slots[size_t(key)].second;
+	}
+
+	/** \brief Adds an entry unless its key is present.
+	*	\param entry is the entry to add.
+	*	\return an iterator to the entry of the key, and whether it was
+	*			added.
+	*
+	*	The slots up to the key are created if need be. This function
+	*	throws std::out_of_range if the key is negative.
+	*/
+	std::pair<iterator, bool> insert(const value_type& entry)
+	{
+		if (entry.first < K())
+			throw std::out_of_range("direct_map::insert: negative key");
+
+		size_t slot = size_t(entry.first);
+
+		while (slots.size() <= slot)
+		{
+			slots.push_back(value_type(K(slots.size()), T()));
+			present.push_back(false);
+		}
+
+		if (present[slot])
+			return std::make_pair(iterator(this, slot), false);
+
+		slots[slot].second = entry.second;
+		present[slot] = true;
+		++entry_count;
+
+		return std::make_pair(iterator(this, slot), true);
+	}
+	/** \brief Adds a range of entries, skipping present keys.
+	*/
+	template <typename I>
+	void insert(I first, I last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+	/** \brief Removes the entry of a key.
+	*	\param key is the key of the entry.
+	*	\return the number of entries removed.
+	*
+	*	The slot is kept for the key's return.
+	*/
+	size_t erase(const K& key)
+	{
+		if (!contains(key))
+			return 0;
+
+		slots[size_t(key)].second = T();
+		present[size_t(key)] = false;
+		--entry_count;
+
+		return 1;
+	}
+	/** \brief Swaps two maps.
+	*	\param rhs is the other map.
+	*/
+	void swap(direct_map& rhs)
+	{
+		std::swap(entry_count, rhs.entry_count);
+		slots.swap(rhs.slots);
+		present.swap(rhs.present);
+	}
+
+	/** \brief Estimate the memory used by the map.
+	*	\return the bytes of the slots and of their flags.
+	*/
+	size_t get_memory() const
+	{
+		return slots.capacity() * sizeof(value_type) + present.capacity() / 8;
+	}
+
+private:
+	/** \brief Checks whether a key has an entry.
+	*/
+	bool contains(const K& key) const
+	{
+		return !(key < K()) && size_t(key) < slots.size() && present[size_t(key)];
+	}
+
+	/** \brief The number of entries.
+	*/
+	size_t entry_count;
+	/** \brief Slot k holds key k and its value, if it is present.
+	*/
+	slot_list slots;
+	/** \brief Whether each slot holds an entry.
+	*/
+	std::vector<bool> present;
+};
+
+/** \brief Estimate the memory used by a direct_map index.
+*/
+template <typename K, typename T, typename H>
+size_t index_memory(const direct_map<K, T, H>& index)
+{
+	return index.get_memory();
+}
+
+/** \brief Selects direct_map as the vertex index.
+*
+*	For integral keys numbered densely from 0. Finding a vertex is then
+*	an array access, and reserve(vertex_count) sizes the index once.
+*/
+struct direct_index
+{
+	template <typename K, typename T, typename H>
+	struct rebind
+	{
+		typedef direct_map<K, T, H> type;
+	};
+};
+
+#endif // VERTEX_INDEX_H